@@ -23,6 +23,12 @@ if /i "%build%"=="clean" (
     %CL_DEBUG% %VENDOR_UNITS% %INCLUDE_PATH% /link %LIBS_PATH% /INCREMENTAL:NO %LIBS% /DLL
 ) else if /i "%build%"=="release" (
     cl.exe /DNDEBUG /DLOG_LEVEL=2 /MP /O2 /EHsc /nologo /Fobuild\\win32\\ /Ivendor\\ src\\main.c %VENDOR_UNITS% /link /NOEXP /NOIMPLIB %LIBS% /OUT:build\\win32\\main.exe
+) else if /i "%build%"=="pack" (
+    cl.exe /DNDEBUG /DLOG_LEVEL=0 /O2 /EHsc /nologo /Fobuild\\win32\\ /Ivendor\\ %INCLUDE_PATH% src\\tools\\packer.c /link %LIBS_PATH% %LIBS% /OUT:build\\win32\\packer.exe
+    build\\win32\\packer.exe data.pack
+) else if /i "%build%"=="audiobench" (
+    cl.exe /DNDEBUG /DLOG_LEVEL=0 /O2 /EHsc /nologo /Fobuild\\win32\\ /Ivendor\\ %INCLUDE_PATH% src\\tools\\audiobench.c %VENDOR_UNITS% /link %LIBS_PATH% %LIBS% /OUT:build\\win32\\audiobench.exe
+    build\\win32\\audiobench.exe
 ) else (
     %CL_DEBUG% %INCLUDE_PATH% /link %LIBS_PATH% /INCREMENTAL:NO build\\debug\\glad.obj %LIBS% /PDB:build\\debug\\game%TIMESTAMP%.pdb /DLL /NOEXP
 )
\ No newline at end of file
@@ -0,0 +1,87 @@
+#version 460 core
+
+// Compiled once per step of the bloom chain, with BLOOM_PASS defined to one of these
+#define BLOOM_EXTRACT 0
+#define BLOOM_DOWN 1
+#define BLOOM_BLUR_H 2
+#define BLOOM_BLUR_V 3
+#define BLOOM_UP 4
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D tex0;
+uniform sampler2D tex1;
+uniform vec2 texScale0;
+
+const float threshold = 0.8;
+const float knee = 0.2;
+
+// 9-tap Gaussian in 5 fetches, the center and 2 per side, with the taps between texels
+// merged through bilinear filtering
+const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+// Four bilinear taps, which average the 4x4 source texels under this output texel
+vec3 downsample(vec2 uv) {
+    vec2 texel = 1.0 / vec2(textureSize(tex0, 0));
+    vec2 lo = texel * 0.5;
+    vec2 hi = texScale0 - texel * 0.5;
+    uv *= texScale0;
+
+    vec3 sum = texture(tex0, clamp(uv + texel * vec2(-1, -1), lo, hi)).rgb;
+    sum += texture(tex0, clamp(uv + texel * vec2(1, -1), lo, hi)).rgb;
+    sum += texture(tex0, clamp(uv + texel * vec2(-1, 1), lo, hi)).rgb;
+    sum += texture(tex0, clamp(uv + texel * vec2(1, 1), lo, hi)).rgb;
+    return sum * 0.25;
+}
+
+// Keeps what's over the threshold, easing in over the knee so it doesn't pop
+vec3 brightPass(vec3 color) {
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 0.0001);
+    return color * max(soft, brightness - threshold) / max(brightness, 0.0001);
+}
+
+vec3 blur(vec2 uv, vec2 dir) {
+    vec2 step = dir / vec2(textureSize(tex0, 0));
+    vec3 sum = texture(tex0, uv).rgb * weights[0];
+    for (int i = 1; i < 3; i++) {
+        sum += texture(tex0, uv + offsets[i] * step).rgb * weights[i];
+        sum += texture(tex0, uv - offsets[i] * step).rgb * weights[i];
+    }
+    return sum;
+}
+
+// 3x3 tent over the smaller level, which smooths out the blockiness of upsampling
+vec3 upsample(vec2 uv) {
+    vec2 texel = 1.0 / vec2(textureSize(tex1, 0));
+    vec3 sum = texture(tex1, uv).rgb * 4.0;
+    sum += texture(tex1, uv + texel * vec2(-1, 0)).rgb * 2.0;
+    sum += texture(tex1, uv + texel * vec2(1, 0)).rgb * 2.0;
+    sum += texture(tex1, uv + texel * vec2(0, -1)).rgb * 2.0;
+    sum += texture(tex1, uv + texel * vec2(0, 1)).rgb * 2.0;
+    sum += texture(tex1, uv + texel * vec2(-1, -1)).rgb;
+    sum += texture(tex1, uv + texel * vec2(1, -1)).rgb;
+    sum += texture(tex1, uv + texel * vec2(-1, 1)).rgb;
+    sum += texture(tex1, uv + texel * vec2(1, 1)).rgb;
+    return sum / 16.0;
+}
+
+void main() {
+#if BLOOM_PASS == BLOOM_EXTRACT
+    vec3 color = brightPass(downsample(TexCoord));
+#elif BLOOM_PASS == BLOOM_DOWN
+    vec3 color = downsample(TexCoord);
+#elif BLOOM_PASS == BLOOM_BLUR_H
+    vec3 color = blur(TexCoord, vec2(1, 0));
+#elif BLOOM_PASS == BLOOM_BLUR_V
+    vec3 color = blur(TexCoord, vec2(0, 1));
+#else
+    vec3 color = texture(tex0, TexCoord).rgb + upsample(TexCoord);
+#endif
+
+    FragColor = vec4(color, 1.0);
+}
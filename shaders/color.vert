@@ -0,0 +1,14 @@
+#version 460 core
+
+// +BUFFER
+layout(location = 0) in vec2 aPos; // World space
+layout(location = 1) in vec4 aColor;
+
+out vec4 vColor;
+
+#include "common.glsl"
+
+void main() {
+    vColor = aColor;
+    gl_Position = worldToClip(aPos);
+}
@@ -0,0 +1,23 @@
+// Set by ShaderUse for every program
+
+// Globals
+uniform int t;
+uniform vec2 res;
+
+// Camera, from world to clip space. Built on the CPU by CameraViewProj.
+uniform mat3 viewProj;
+
+mat2 rotate(float angle) {
+    float s = sin(angle);
+    float c = cos(angle);
+    return mat2(c, s, -s, c);
+}
+
+vec4 worldToClip(vec2 world) {
+    return vec4((viewProj * vec3(world, 1.0)).xy, 0.0, 1.0);
+}
+
+// World units covered by one screen pixel
+float worldPerPixel() {
+    return 1.0 / length(viewProj[0].xy * res * 0.5);
+}
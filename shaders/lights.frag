@@ -0,0 +1,44 @@
+#version 460 core
+
+out vec4 FragColor;
+
+in vec2 vLocal;
+flat in vec4 vLight;
+flat in vec4 vColor;
+
+// Distance to the closest occluder over the radius, per angle. One row per light.
+uniform sampler2D shadowMap;
+
+const float PI = 3.14159265359;
+const float TAU = 6.28318530718;
+const float coneSoftness = 0.15; // Radians over which spot lights fade out
+
+// Lit fraction at distance d, filtered over the texels on either side of the angle
+float shadow(float angle, float d) {
+    ivec2 size = textureSize(shadowMap, 0);
+    int x = int(floor((angle / TAU + 0.5) * float(size.x)));
+    int row = int(vLight.w);
+
+    float lit = 0.0;
+    for (int i = -1; i <= 1; i++) {
+        float occluder = texelFetch(shadowMap, ivec2((x + i + size.x) % size.x, row), 0).r;
+        lit += step(d, occluder);
+    }
+    return lit / 3.0;
+}
+
+void main() {
+    float d = length(vLocal) / vLight.x;
+    if (d >= 1.0) discard;
+
+    float angle = atan(vLocal.y, vLocal.x);
+    float light = (1.0 - d) * (1.0 - d) * shadow(angle, d);
+
+    // A cone of 0, or of PI and over, is a point light
+    if (vLight.z > 0.0 && vLight.z < PI) {
+        float off = abs(mod(angle - vLight.y + PI, TAU) - PI);
+        light *= 1.0 - smoothstep(vLight.z - coneSoftness, vLight.z, off);
+    }
+
+    FragColor = vec4(vColor.rgb * vColor.a * light, 0.0);
+}
@@ -0,0 +1,21 @@
+#version 460 core
+
+// +BUFFER +INDEXED +INSTANCED
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec4 iLight; // Position, radius, direction
+layout(location = 3) in vec4 iColor;
+layout(location = 4) in float iCone;
+
+out vec2 vLocal;      // From the light, in world units
+flat out vec4 vLight; // Radius, direction, cone, shadow map row
+flat out vec4 vColor;
+
+#include "common.glsl"
+
+void main() {
+    vLocal = aPos * iLight.z * 2.0;
+    vLight = vec4(iLight.zw, iCone, float(gl_InstanceID));
+    vColor = iColor;
+    gl_Position = worldToClip(iLight.xy + vLocal);
+}
@@ -0,0 +1,22 @@
+#version 460 core
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D tex0; // Scene
+uniform sampler2D tex1; // Lights, over the ambient color
+uniform vec2 texScale0;
+uniform vec2 texScale1;
+
+// Clamped half a texel inside the part drawn to, like scene() in post.frag
+vec4 sampleScaled(sampler2D tex, vec2 scale, vec2 uv) {
+    vec2 halfTexel = 0.5 / vec2(textureSize(tex, 0));
+    return texture(tex, clamp(uv * scale, halfTexel, scale - halfTexel));
+}
+
+void main() {
+    vec4 scene = sampleScaled(tex0, texScale0, TexCoord);
+    vec3 light = sampleScaled(tex1, texScale1, TexCoord).rgb;
+    FragColor = vec4(scene.rgb * light, scene.a);
+}
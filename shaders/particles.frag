@@ -0,0 +1,14 @@
+#version 460 core
+
+out vec4 FragColor;
+
+in vec2 vUV;
+flat in vec4 vColor;
+
+// Round, with the edge faded over the outer fifth
+void main() {
+    float d = length(vUV - 0.5) * 2.0;
+    float alpha = 1.0 - smoothstep(0.8, 1.0, d);
+    if (alpha <= 0.0) discard;
+    FragColor = vec4(vColor.rgb, vColor.a * alpha);
+}
@@ -0,0 +1,11 @@
+// Matches Particle in particles.h
+struct Particle {
+    vec2 pos;
+    vec2 vel;
+    vec4 color;
+    vec4 endColor;
+    float size;
+    float endSize;
+    float age;
+    float life;
+};
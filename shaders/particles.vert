@@ -0,0 +1,24 @@
+#version 460 core
+
+// +INDEXED +INSTANCED, with the instances read from the particle buffer
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aUV;
+
+#include "common.glsl"
+#include "particles.glsl"
+
+layout(std430, binding = 0) readonly buffer Particles {
+    Particle particles[];
+};
+
+out vec2 vUV;
+flat out vec4 vColor;
+
+void main() {
+    Particle p = particles[gl_InstanceID];
+    float t = clamp(p.age / p.life, 0.0, 1.0);
+
+    vUV = aUV;
+    vColor = mix(p.color, p.endColor, t);
+    gl_Position = worldToClip(p.pos + aPos * mix(p.size, p.endSize, t));
+}
@@ -4,10 +4,22 @@ out vec4 FragColor;
 
 in vec2 TexCoord;
 
-uniform sampler2D screenTexture;
+uniform sampler2D tex0;
+uniform vec2 texScale0; // Part of tex0 the scene was drawn to
+
+#ifdef BLOOM
+uniform sampler2D tex1;
+const float bloomIntensity = 0.6;
+#endif
 
 uniform vec2 res;
 
+// The scene at uv in [0, 1], clamped half a texel in so filtering stays inside its part
+vec4 scene(vec2 uv) {
+    vec2 halfTexel = 0.5 / vec2(textureSize(tex0, 0));
+    return texture(tex0, clamp(uv * texScale0, halfTexel, texScale0 - halfTexel));
+}
+
 vec2 random(vec2 uv) {
     uv = vec2(dot(uv, vec2(127.1, 311.7)),
             dot(uv, vec2(269.5, 183.3)));
@@ -59,9 +71,13 @@ void main() {
     float vignette = to_vignette(TexCoord);
     vec3 wave = color_wave(uv);
 
-    vec4 tex = texture(screenTexture, uv);
+    vec4 tex = scene(uv);
 
     // if (uv.x < 0 || uv.x > 1 || uv.y < 0 || uv.y > 1) discard;
     // FragColor = vec4(wave * tex.rgb - vignette, tex.a);
-    FragColor = texture(screenTexture, TexCoord);
+    vec4 color = scene(TexCoord);
+#ifdef BLOOM
+    color.rgb += texture(tex1, TexCoord).rgb * bloomIntensity;
+#endif
+    FragColor = color;
 }
@@ -1,12 +1,10 @@
 #version 460 core
 
-// #+ BUFFER
-layout(location = 0) in vec2 aPos;
-layout(location = 1) in vec2 aTex;
-
 out vec2 TexCoord;
 
+// One triangle covering the screen, built from gl_VertexID alone
 void main() {
-    TexCoord = aTex;
-    gl_Position = vec4(aPos, 0.0, 1.0);
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
 }
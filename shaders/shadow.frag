@@ -0,0 +1,31 @@
+#version 460 core
+
+out vec4 FragColor;
+
+flat in vec4 vSegment;
+flat in float vRadius;
+
+uniform vec2 shadowSize;
+
+const float TAU = 6.28318530718;
+
+float cross2(vec2 a, vec2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+// Where this texel's ray hits the segment, as a fraction of the light's radius. The shadow map
+// is blended with GL_MIN, so the closest segment wins.
+void main() {
+    float angle = (gl_FragCoord.x / shadowSize.x - 0.5) * TAU;
+    vec2 dir = vec2(cos(angle), sin(angle));
+    vec2 a = vSegment.xy;
+    vec2 edge = vSegment.zw - a;
+
+    float denom = cross2(dir, edge);
+    if (abs(denom) < 1e-6) discard;
+    float t = cross2(a, edge) / denom;
+    float s = cross2(a, dir) / denom;
+    if (t < 0.0 || s < 0.0 || s > 1.0) discard;
+
+    FragColor = vec4(t / vRadius, 0.0, 0.0, 1.0);
+}
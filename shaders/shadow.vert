@@ -0,0 +1,25 @@
+#version 460 core
+
+// +BUFFER +INDEXED +INSTANCED
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec4 iSegment;
+layout(location = 3) in vec4 iLight; // Position, radius, shadow map row
+layout(location = 4) in vec2 iSpan;  // Angles covered, as [0, 1] around the light
+
+flat out vec4 vSegment; // Relative to the light
+flat out float vRadius;
+
+uniform vec2 shadowSize;
+
+// Covers the span in the light's row, a texel wider on each side so spans narrower than one
+// texel still reach a texel center. shadow.frag drops the texels the segment doesn't hit.
+void main() {
+    vSegment = iSegment - iLight.xyxy;
+    vRadius = iLight.z;
+
+    vec2 texel = 1.0 / shadowSize;
+    float u = mix(iSpan.x - texel.x, iSpan.y + texel.x, aPos.x + 0.5);
+    float v = (iLight.w + 0.5 + aPos.y) * texel.y;
+    gl_Position = vec4(u * 2.0 - 1.0, v * 2.0 - 1.0, 0.0, 1.0);
+}
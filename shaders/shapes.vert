@@ -1,48 +1,30 @@
 #version 460 core
 
-// +BUFFER +INDEXED
+// +BUFFER +INDEXED +INSTANCED
 layout(location = 0) in vec2 aPos;
 layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec4 iRect; // Center, size
+layout(location = 3) in vec4 iColor;
+layout(location = 4) in vec3 iParams; // Rotation, rounding, thickness
+layout(location = 5) in uint iShape;
 
-out vec2 vUV;
+out vec2 vLocal; // Relative to the shape's center, in world units
+flat out vec2 vHalfSize;
+flat out vec4 vColor;
+flat out vec2 vParams; // Rounding, thickness
+flat out int vShape;
 
-// Globals
-uniform int t;
-uniform vec2 res;
-
-uniform vec2 camPos;
-uniform float camZoom;
-uniform float camRotation;
-
-uniform vec2 pos;
-uniform vec2 size;
-uniform vec4 color;
-
-vec2 rotate(vec2 p, float angle) {
-    float c = cos(angle);
-    float s = sin(angle);
-    return vec2(c * p.x - s * p.y, s * p.x + c * p.y);
-}
+#include "common.glsl"
 
 void main() {
-    // Apply zoom
-    float camScale = pow(0.5, camZoom);
-    vec2 aPosCentered = aPos - camPos / res; // Shift everything relative to the camera
-    vec2 aPosZoomed = aPosCentered / camScale;
-
-    // Apply rotation
-    float s = sin(-camRotation); // Negative to rotate the world opposite to camera
-    float c = cos(-camRotation);
-    vec2 aPosZoomedAndRotated = vec2(
-            aPosZoomed.x * c - aPosZoomed.y * s,
-            aPosZoomed.x * s + aPosZoomed.y * c
-        );
-
-    vec2 aspectRatio = rotate(vec2(res.x / res.y, 1.0), camRotation);
-    vec2 camPosN = (camPos / res) * aspectRatio;
-    vec2 aPosTransformed = aPosZoomedAndRotated - camPosN;
+    vHalfSize = iRect.zw * 0.5;
+    vColor = iColor;
+    vParams = iParams.yz;
+    vShape = int(iShape);
 
-    gl_Position = vec4(aPosTransformed, 0.0, 1.0);
+    // One pixel of margin on each side for the antialiased edge
+    vLocal = aPos * (iRect.zw + 2.0 * worldPerPixel());
 
-    vUV = aUV;
+    vec2 world = iRect.xy + rotate(iParams.x) * vLocal;
+    gl_Position = worldToClip(world);
 }
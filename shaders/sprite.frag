@@ -0,0 +1,12 @@
+#version 460 core
+
+out vec4 FragColor;
+
+in vec2 vUV;
+in vec4 vColor;
+
+uniform sampler2D tex0;
+
+void main() {
+    FragColor = texture(tex0, vUV) * vColor;
+}
@@ -0,0 +1,24 @@
+#version 460 core
+
+// +BUFFER +INDEXED +INSTANCED
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec4 iRect; // Center, size
+layout(location = 3) in vec4 iUV; // Offset, size
+layout(location = 4) in vec4 iColor;
+layout(location = 5) in float iRotation;
+
+out vec2 vUV;
+out vec4 vColor;
+
+#include "common.glsl"
+
+void main() {
+    vUV = iUV.xy + aUV * iUV.zw;
+    vColor = iColor;
+
+    // Object transform
+    vec2 world = iRect.xy + rotate(iRotation) * (aPos * iRect.zw);
+
+    gl_Position = worldToClip(world);
+}
@@ -0,0 +1,17 @@
+#version 460 core
+
+out vec4 FragColor;
+
+in vec2 vUV;
+in vec4 vColor;
+
+// Signed distance field atlas, 0.5 on the glyph outline
+uniform sampler2D tex0;
+
+void main() {
+    float dist = texture(tex0, vUV).r;
+    float width = fwidth(dist);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+
+    FragColor = vec4(vColor.rgb, vColor.a * alpha);
+}
@@ -1,34 +1,61 @@
 #version 460
 
-in vec2 worldPos;
+in vec2 vUV;
 out vec4 fragColor;
 
+#define MAX_TILE_ANIMS 64
+#define MAX_TILE_ANIM_FRAMES 256
+#define TILE_EMPTY 0xFFFFFFFFu
+#define TILE_ANIMATED 0x80000000u
+
+#include "common.glsl"
+
 uniform sampler2D tileAtlas; // The tile atlas
-uniform usampler2D tilemap; // Integer texture with tile indices
+uniform usampler2DArray tilemap; // Integer texture with the chunk's tile indices, one layer each
+uniform int layerCount;
 
-uniform ivec2 mapSize; // Width/height of tilemap in tiles
+uniform ivec2 chunkTiles; // Width/height of the drawn chunk in tiles
 uniform ivec2 atlasSize; // Width/height of atlas in tiles
-uniform float tileSize; // Size of each tile in world units
+uniform vec4 atlasRect; // Offset/size of the tiles inside the atlas texture
+
+uniform uvec4 anims[MAX_TILE_ANIMS]; // First frame, frame count, ms per frame
+uniform uint animFrames[MAX_TILE_ANIM_FRAMES];
+
+uint resolveTile(uint tile) {
+    if ((tile & TILE_ANIMATED) == 0u) return tile;
+
+    // Maps are filled in bulk without going through TilemapSet, so ids aren't trusted here
+    uvec4 anim = anims[min(tile & ~TILE_ANIMATED, uint(MAX_TILE_ANIMS - 1))];
+    uint frame = (uint(t) / max(anim.z, 1u)) % max(anim.y, 1u);
+    return animFrames[min(anim.x + frame, uint(MAX_TILE_ANIM_FRAMES - 1))];
+}
 
 void main() {
     // Compute which tile this fragment is on
-    ivec2 tileCoord = ivec2(floor(worldPos / tileSize));
+    vec2 tilePos = vUV * vec2(chunkTiles);
+    ivec2 tileCoord = min(ivec2(floor(tilePos)), chunkTiles - 1);
 
-    // Discard fragments outside the map
-    if (tileCoord.x < 0 || tileCoord.y < 0 || tileCoord.x >= mapSize.x || tileCoord.y >= mapSize.y)
-        discard;
+    // Local UV within the tile
+    vec2 localUV = fract(tilePos);
 
-    // Get the tile index
-    uint tileIndex = texelFetch(tilemap, tileCoord, 0).r;
+    // Composite the layers back to front
+    vec4 result = vec4(0);
+    for (int layer = 0; layer < layerCount; layer++) {
+        uint tileIndex = texelFetch(tilemap, ivec3(tileCoord, layer), 0).r;
+        if (tileIndex == TILE_EMPTY) continue;
+        tileIndex = resolveTile(tileIndex);
 
-    // Compute the UV offset in the atlas
-    ivec2 atlasTileCoord = ivec2(tileIndex % atlasSize.x, tileIndex / atlasSize.x);
+        // Compute the UV offset in the atlas
+        ivec2 atlasTileCoord = ivec2(tileIndex % atlasSize.x, tileIndex / atlasSize.x);
 
-    // Local UV within the tile
-    vec2 localUV = fract(worldPos / tileSize);
+        // Final UV to sample from the atlas
+        vec2 uv = atlasRect.xy + (vec2(atlasTileCoord) + localUV) / vec2(atlasSize) * atlasRect.zw;
 
-    // Final UV to sample from the atlas
-    vec2 uv = (vec2(atlasTileCoord) + localUV) / vec2(atlasSize);
+        vec4 color = textureLod(tileAtlas, uv, 0);
+        result.rgb = mix(result.rgb, color.rgb, color.a);
+        result.a = color.a + result.a * (1.0 - color.a);
+    }
 
-    fragColor = texture(tileAtlas, uv);
+    if (result.a == 0) discard;
+    fragColor = result;
 }
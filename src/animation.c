@@ -0,0 +1,148 @@
+#include "animation.h"
+
+AnimLibrary NewAnimLibrary(Atlas *atlas, u32 maxClips, u32 maxFrames) {
+    AnimLibrary result = {
+        .clips    = SDL_calloc(maxClips, sizeof(AnimClip)),
+        .clipMax  = maxClips,
+        .frames   = SDL_calloc(maxFrames, sizeof(AnimFrame)),
+        .frameMax = maxFrames,
+    };
+
+    AtlasSprite *white = AtlasGet(atlas, (Sprite){0});
+    result.frames[0]   = (AnimFrame){white->uv, 1};
+    result.clips[0]    = (AnimClip){.page = white->page, .frameSize = white->size, .count = 1};
+    result.frameCount  = 1;
+    result.clipCount   = 1;
+    return result;
+}
+
+Clip NewClip(Sprite sheet, v2i frameSize, u32 first, u32 count, f32 frameTime, AnimLoop loop) {
+    AnimLibrary *lib = Graphics()->anims;
+    AtlasSprite *s   = AtlasGet(Graphics()->atlas, sheet);
+
+    if (frameSize.w <= 0 || frameSize.h <= 0) {
+        LOG_ERROR("Invalid frame size %dx%d", frameSize.w, frameSize.h);
+        return (Clip){0};
+    }
+    u32 columns = (u32)(s->size.w / frameSize.w);
+    u32 rows    = (u32)(s->size.h / frameSize.h);
+    if (count == 0 || first + count > columns * rows) {
+        LOG_ERROR("Frames %u to %u aren't all in a sheet of %ux%u frames", first,
+                  first + count - 1, columns, rows);
+        return (Clip){0};
+    }
+    if (lib->clipCount == lib->clipMax || lib->frameCount + count > lib->frameMax) {
+        LOG_ERROR("Animation library is full");
+        return (Clip){0};
+    }
+
+    lib->clips[lib->clipCount] = (AnimClip){
+        .page      = s->page,
+        .frameSize = frameSize,
+        .first     = lib->frameCount,
+        .count     = count,
+        .loop      = loop,
+    };
+
+    v2 texel = {s->uv.w / s->size.w, s->uv.h / s->size.h};
+    for (u32 i = 0; i < count; i++) {
+        u32 column = (first + i) % columns, row = (first + i) / columns;
+        lib->frames[lib->frameCount++] = (AnimFrame){
+            .uv       = {s->uv.x + column * frameSize.w * texel.x,
+                         s->uv.y + row * frameSize.h * texel.y, frameSize.w * texel.x,
+                         frameSize.h * texel.y},
+            .duration = MAX(frameTime, ANIM_MIN_FRAME_TIME),
+        };
+    }
+
+    return (Clip){.id = lib->clipCount++};
+}
+
+void ClipFrameDuration(Clip clip, u32 frame, f32 seconds) {
+    AnimLibrary *lib = Graphics()->anims;
+    AnimClip    *c   = &lib->clips[clip.id < lib->clipCount ? clip.id : 0];
+    if (frame >= c->count) return;
+
+    lib->frames[c->first + frame].duration = MAX(seconds, ANIM_MIN_FRAME_TIME);
+}
+
+Animators NewAnimators(u32 count, Clip clip) {
+    Animators result = {
+        .count   = count,
+        .clip    = SDL_malloc(count * sizeof(Clip)),
+        .frame   = SDL_calloc(count, sizeof(u32)),
+        .step    = SDL_malloc(count * sizeof(i32)),
+        .elapsed = SDL_calloc(count, sizeof(f32)),
+        .speed   = SDL_malloc(count * sizeof(f32)),
+    };
+    for (u32 i = 0; i < count; i++) {
+        result.clip[i]  = clip;
+        result.step[i]  = 1;
+        result.speed[i] = 1;
+    }
+    return result;
+}
+
+void AnimatorPlay(Animators *animators, u32 i, Clip clip) {
+    if (animators->clip[i].id == clip.id && animators->step[i]) return;
+
+    animators->clip[i]    = clip;
+    animators->frame[i]   = 0;
+    animators->step[i]    = 1;
+    animators->elapsed[i] = 0;
+}
+
+bool AnimatorDone(const Animators *animators, u32 i) {
+    return animators->step[i] == 0;
+}
+
+void UpdateAnimators(Animators *animators, f32 dt) {
+    const AnimLibrary *lib     = Graphics()->anims;
+    const Clip        *clip    = animators->clip;
+    u32               *frame   = animators->frame;
+    i32               *step    = animators->step;
+    f32               *elapsed = animators->elapsed;
+    const f32         *speed   = animators->speed;
+
+    for (u32 i = 0; i < animators->count; i++) {
+        const AnimClip  *c      = &lib->clips[clip[i].id];
+        const AnimFrame *frames = &lib->frames[c->first];
+        u32              f      = frame[i];
+        i32              s      = step[i];
+        f32              t      = elapsed[i] + dt * speed[i];
+
+        while (s && t >= frames[f].duration) {
+            t -= frames[f].duration;
+
+            i32 next = (i32)f + s;
+            if (next >= 0 && next < (i32)c->count) {
+                f = (u32)next;
+            } else if (c->loop == ANIM_LOOP) {
+                f = 0;
+            } else if (c->loop == ANIM_PINGPONG) {
+                s = -s;
+                if (c->count > 1) f = (u32)((i32)f + s);
+            } else {
+                s = 0;
+                t = 0;
+            }
+        }
+
+        frame[i]   = f;
+        step[i]    = s;
+        elapsed[i] = t;
+    }
+}
+
+void DrawAnimator(const Animators *animators, u32 i, v2 pos, f32 rotation, v4 tint) {
+    const AnimLibrary *lib   = Graphics()->anims;
+    const AnimClip    *clip  = &lib->clips[animators->clip[i].id];
+    const AnimFrame   *frame = &lib->frames[clip->first + animators->frame[i]];
+
+    Rect dst = {pos.x, pos.y, clip->frameSize.w, clip->frameSize.h};
+    BatchPush(Graphics()->atlas->pages[clip->page].id, dst, frame->uv, tint, rotation);
+}
+
+void DrawAnimators(const Animators *animators, const v2 *pos) {
+    for (u32 i = 0; i < animators->count; i++) DrawAnimator(animators, i, pos[i], 0, WHITE);
+}
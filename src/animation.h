@@ -0,0 +1,60 @@
+#pragma once
+
+#include "atlas.h"
+#include "engine.h"
+#include "graphics.h"
+
+// A clip is a run of equally sized frames in a sheet, left to right then top to bottom. The
+// sheet is packed into the atlas whole, so a frame is just a rect of an atlas page and every
+// animated sprite goes through the sprite batch: thousands of them on the same page are one
+// instanced draw, whatever frame each is on.
+#define ANIM_MIN_FRAME_TIME 0.001f // Seconds
+
+typedef enum { ANIM_ONCE, ANIM_LOOP, ANIM_PINGPONG } AnimLoop;
+
+typedef struct {
+    Rect uv;
+    f32  duration; // Seconds
+} AnimFrame;
+
+typedef struct {
+    u32      page;
+    v2i      frameSize;
+    u32      first, count; // In the library's frames
+    AnimLoop loop;
+} AnimClip;
+
+typedef struct {
+    u32 id;
+} Clip;
+
+// Clip 0 is the atlas' white texel, which clips that fail to load fall back to
+typedef struct AnimLibrary {
+    AnimClip  *clips;
+    u32        clipCount, clipMax;
+    AnimFrame *frames;
+    u32        frameCount, frameMax;
+} AnimLibrary;
+AnimLibrary NewAnimLibrary(Atlas *atlas, u32 maxClips, u32 maxFrames);
+
+Clip NewClip(Sprite sheet, v2i frameSize, u32 first, u32 count, f32 frameTime, AnimLoop loop);
+void ClipFrameDuration(Clip clip, u32 frame, f32 seconds);
+
+// Animation state for count things, one array per field so UpdateAnimators streams through
+// them. They're indexed like the game's other per entity arrays.
+typedef struct {
+    u32   count;
+    Clip *clip;
+    u32  *frame;   // Within the clip
+    i32  *step;    // Direction through the frames, 0 once an ANIM_ONCE clip is done
+    f32  *elapsed; // Seconds into the current frame
+    f32  *speed;   // Playback rate, 0 pauses
+} Animators;
+Animators NewAnimators(u32 count, Clip clip);
+void      AnimatorPlay(Animators *animators, u32 i, Clip clip); // Restarts unless already on it
+bool      AnimatorDone(const Animators *animators, u32 i);
+void      UpdateAnimators(Animators *animators, f32 dt);
+
+// pos is the top left corner, as with DrawSprite
+void DrawAnimator(const Animators *animators, u32 i, v2 pos, f32 rotation, v4 tint);
+void DrawAnimators(const Animators *animators, const v2 *pos);
@@ -0,0 +1,239 @@
+#include "assets.h"
+#include "pack.h"
+
+AssetsCtx InitAssets(u64 budget) {
+    AssetsCtx result = {
+        .slots  = SDL_calloc(MAX_ASSETS, sizeof(AssetSlot)),
+        .budget = budget,
+    };
+    return result;
+}
+
+// variant tells apart assets loaded from the same files, like a sound's playback type
+intern u64 AssetKey(AssetType type, u32 variant, cstr a, cstr b) {
+    u64 key = PackHash(a) ^ ((u64)type << 56);
+    if (b) key ^= PackHash(b) * 31;
+    key ^= (u64)variant * 1099511628211ull;
+    return key;
+}
+
+intern AssetSlot *AssetGet(AssetHandle handle, AssetType type) {
+    AssetsCtx *assets = Assets();
+    if (handle.index >= assets->slotCount) return 0;
+
+    AssetSlot *slot = &assets->slots[handle.index];
+    if (slot->gen != handle.gen || slot->type != type) {
+        LOG_ERROR("Stale asset handle %u:%u", handle.index, handle.gen);
+        return 0;
+    }
+
+    slot->lastUse = assets->frame;
+    return slot;
+}
+
+intern void AssetFree(AssetsCtx *assets, AssetSlot *slot) {
+    switch (slot->type) {
+    case ASSET_TEXTURE: glDeleteTextures(1, &slot->texture.id); break;
+    case ASSET_SOUND: SoundFree(slot->sound); break;
+    case ASSET_SHADER: glDeleteProgram(slot->shader.id); break;
+    default: break;
+    }
+
+    assets->cpuBytes -= slot->cpuBytes;
+    assets->gpuBytes -= slot->gpuBytes;
+    *slot = (AssetSlot){.gen = slot->gen + 1};
+}
+
+// Fonts are never evicted and don't count toward the budget: their glyphs live in the shared
+// atlas, which can't give space back
+intern void AssetEvict(AssetsCtx *assets) {
+    while (assets->cpuBytes + assets->gpuBytes > assets->budget) {
+        AssetSlot *lru = 0;
+        for (u32 i = 0; i < assets->slotCount; i++) {
+            AssetSlot *slot = &assets->slots[i];
+            if (slot->type == ASSET_NONE || slot->type == ASSET_FONT || slot->refs) continue;
+            if (!lru || slot->lastUse < lru->lastUse) lru = slot;
+        }
+        if (!lru) return;
+
+        AssetFree(assets, lru);
+    }
+}
+
+// Returns the cached slot for key with a new reference, or reserves an empty one. Lookups are
+// a linear scan, which is fine at the few hundred assets a game has loaded at once.
+intern AssetSlot *AssetFind(AssetsCtx *assets, u64 key, AssetHandle *handle) {
+    AssetSlot *empty = 0;
+    for (u32 i = 0; i < assets->slotCount; i++) {
+        AssetSlot *slot = &assets->slots[i];
+        if (slot->type == ASSET_NONE) {
+            if (!empty) empty = slot;
+        } else if (slot->key == key) {
+            slot->refs++;
+            slot->lastUse = assets->frame;
+            *handle       = (AssetHandle){i, slot->gen};
+            return slot;
+        }
+    }
+
+    if (!empty) {
+        if (assets->slotCount == MAX_ASSETS) {
+            LOG_ERROR("Too many assets loaded");
+            return 0;
+        }
+        empty = &assets->slots[assets->slotCount++];
+    }
+
+    if (empty->gen == 0) empty->gen = 1;
+    *handle = (AssetHandle){(u32)(empty - assets->slots), empty->gen};
+    return empty;
+}
+
+// Gives back a slot AssetFind reserved for an asset that then failed to load
+intern AssetHandle AssetCancel(AssetsCtx *assets, AssetSlot *slot) {
+    if (slot == &assets->slots[assets->slotCount - 1]) assets->slotCount--;
+    return (AssetHandle){0};
+}
+
+intern AssetHandle AssetCommit(AssetsCtx *assets, AssetSlot *slot, AssetHandle handle, u64 key,
+                               AssetType type) {
+    slot->key     = key;
+    slot->type    = type;
+    slot->refs    = 1;
+    slot->lastUse = assets->frame;
+    assets->cpuBytes += slot->cpuBytes;
+    assets->gpuBytes += slot->gpuBytes;
+    AssetEvict(assets);
+    return handle;
+}
+
+AssetHandle AcquireTexture(cstr path) {
+    AssetsCtx  *assets = Assets();
+    AssetHandle handle = {0};
+    u64         key    = AssetKey(ASSET_TEXTURE, 0, path, 0);
+    AssetSlot  *slot   = AssetFind(assets, key, &handle);
+    if (!slot || slot->type) return handle;
+
+    slot->texture = NewTexture(path);
+    if (!slot->texture.id) return AssetCancel(assets, slot);
+    slot->pathHash = PackHash(path);
+    slot->gpuBytes = (u64)slot->texture.size.w * slot->texture.size.h * 4;
+
+    return AssetCommit(assets, slot, handle, key, ASSET_TEXTURE);
+}
+
+AssetHandle AcquireSound(cstr path, PlaybackType type) {
+    AssetsCtx  *assets = Assets();
+    AssetHandle handle = {0};
+    u64         key    = AssetKey(ASSET_SOUND, type, path, 0);
+    AssetSlot  *slot   = AssetFind(assets, key, &handle);
+    if (!slot || slot->type) return handle;
+
+    slot->sound = NewSound(path, type);
+    if (!slot->sound.id) return AssetCancel(assets, slot);
+    const SoundBuffer *buf = &Audio()->sounds[slot->sound.id];
+    slot->pathHash = PackHash(path);
+    slot->cpuBytes = PackContains(Pack(), buf->data) ? 0 : buf->len;
+
+    return AssetCommit(assets, slot, handle, key, ASSET_SOUND);
+}
+
+AssetHandle AcquireFont(cstr path, f32 size) {
+    AssetsCtx  *assets = Assets();
+    AssetHandle handle = {0};
+    u64         key    = AssetKey(ASSET_FONT, (u32)(size * 64.0f), path, 0);
+    AssetSlot  *slot   = AssetFind(assets, key, &handle);
+    if (!slot || slot->type) return handle;
+
+    slot->font = GetFont(path, size);
+    if (!slot->font) return AssetCancel(assets, slot);
+
+    return AssetCommit(assets, slot, handle, key, ASSET_FONT);
+}
+
+AssetHandle AcquireShader(cstr vertPath, cstr fragPath) {
+    AssetsCtx  *assets = Assets();
+    AssetHandle handle = {0};
+    u64         key    = AssetKey(ASSET_SHADER, 0, vertPath, fragPath);
+    AssetSlot  *slot   = AssetFind(assets, key, &handle);
+    if (!slot || slot->type) return handle;
+
+    slot->shader = ShaderFromPath(vertPath, fragPath);
+    if (!slot->shader.id) return AssetCancel(assets, slot);
+    i32 binaryLen = 0;
+    glGetProgramiv(slot->shader.id, GL_PROGRAM_BINARY_LENGTH, &binaryLen);
+    slot->gpuBytes = (u64)binaryLen;
+
+    return AssetCommit(assets, slot, handle, key, ASSET_SHADER);
+}
+
+void AssetRelease(AssetHandle handle) {
+    if (handle.index >= Assets()->slotCount) return;
+
+    AssetSlot *slot = &Assets()->slots[handle.index];
+    if (slot->gen != handle.gen || slot->refs == 0) return;
+    slot->refs--;
+}
+
+Texture *AssetTexture(AssetHandle handle) {
+    AssetSlot *slot = AssetGet(handle, ASSET_TEXTURE);
+    return slot ? &slot->texture : 0;
+}
+
+Sound *AssetSound(AssetHandle handle) {
+    AssetSlot *slot = AssetGet(handle, ASSET_SOUND);
+    return slot ? &slot->sound : 0;
+}
+
+Font *AssetFont(AssetHandle handle) {
+    AssetSlot *slot = AssetGet(handle, ASSET_FONT);
+    return slot ? slot->font : 0;
+}
+
+Shader *AssetShader(AssetHandle handle) {
+    AssetSlot *slot = AssetGet(handle, ASSET_SHADER);
+    return slot ? &slot->shader : 0;
+}
+
+void UpdateAssets(AssetsCtx *assets) {
+    assets->frame++;
+    AssetEvict(assets);
+}
+
+// Swaps the contents of every asset loaded from path in place, so handles stay valid. If the
+// new file fails to load the old contents are kept.
+void AssetsReloadFile(AssetsCtx *assets, cstr path) {
+    u64 hash = PackHash(path);
+    for (u32 i = 0; i < assets->slotCount; i++) {
+        AssetSlot *slot = &assets->slots[i];
+
+        if (slot->type == ASSET_SHADER && ShaderUsesFile(&slot->shader, path)) {
+            ShaderReload(&slot->shader);
+        } else if (slot->type == ASSET_TEXTURE && slot->pathHash == hash) {
+            Texture texture = NewTexture(path);
+            if (!texture.id) continue;
+
+            glDeleteTextures(1, &slot->texture.id);
+            slot->texture = texture;
+            assets->gpuBytes -= slot->gpuBytes;
+            slot->gpuBytes = (u64)texture.size.w * texture.size.h * 4;
+            assets->gpuBytes += slot->gpuBytes;
+        } else if (slot->type == ASSET_SOUND && slot->pathHash == hash) {
+            Sound sound = NewSound(path, Audio()->sounds[slot->sound.id].type);
+            if (!sound.id) continue;
+
+            SoundFree(slot->sound);
+            slot->sound = sound;
+            assets->cpuBytes -= slot->cpuBytes;
+            slot->cpuBytes = Audio()->sounds[sound.id].len;
+            assets->cpuBytes += slot->cpuBytes;
+        }
+    }
+}
+
+void ShutdownAssets(AssetsCtx *assets) {
+    for (u32 i = 0; i < assets->slotCount; i++)
+        if (assets->slots[i].type != ASSET_NONE) AssetFree(assets, &assets->slots[i]);
+    SDL_free(assets->slots);
+    *assets = (AssetsCtx){0};
+}
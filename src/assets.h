@@ -0,0 +1,56 @@
+#pragma once
+
+#include "audio.h"
+#include "engine.h"
+#include "graphics.h"
+#include "text.h"
+
+// Assets are deduplicated by path and handed out as handles that go stale once the asset is
+// evicted. Released assets stay cached until the total goes over the budget, and then the
+// least recently used ones are freed first.
+#define MAX_ASSETS 1024
+#define ASSET_DEFAULT_BUDGET (256ull * 1024 * 1024)
+
+typedef enum { ASSET_NONE, ASSET_TEXTURE, ASSET_SOUND, ASSET_FONT, ASSET_SHADER } AssetType;
+
+typedef struct {
+    u32 index, gen; // gen 0 is never handed out, so a zeroed handle is always invalid
+} AssetHandle;
+
+typedef struct {
+    u64       key, pathHash;
+    AssetType type;
+    u32       gen, refs;
+    u64       lastUse;
+    u64       cpuBytes, gpuBytes;
+    union {
+        Texture texture;
+        Sound   sound;
+        Font   *font;
+        Shader  shader;
+    };
+} AssetSlot;
+
+typedef struct {
+    AssetSlot *slots;
+    u32        slotCount;
+    u64        cpuBytes, gpuBytes, budget;
+    u64        frame;
+} AssetsCtx;
+AssetsCtx  InitAssets(u64 budget);
+void       UpdateAssets(AssetsCtx *assets);
+void       ShutdownAssets(AssetsCtx *assets);
+void       AssetsReloadFile(AssetsCtx *assets, cstr path);
+AssetsCtx *Assets();
+
+AssetHandle AcquireTexture(cstr path);
+AssetHandle AcquireSound(cstr path, PlaybackType type);
+AssetHandle AcquireFont(cstr path, f32 size);
+AssetHandle AcquireShader(cstr vertPath, cstr fragPath);
+void        AssetRelease(AssetHandle handle);
+
+// These return 0 for stale handles, and mark the asset as used this frame
+Texture *AssetTexture(AssetHandle handle);
+Sound   *AssetSound(AssetHandle handle);
+Font    *AssetFont(AssetHandle handle);
+Shader  *AssetShader(AssetHandle handle);
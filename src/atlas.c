@@ -0,0 +1,180 @@
+#include "atlas.h"
+#include "pack.h"
+
+Skyline NewSkyline(v2i size) {
+    Skyline result  = {.size = size, .nodeCount = 1};
+    result.nodes[0] = (SkylineNode){0, 0, size.w};
+    return result;
+}
+
+intern i32 SkylineFit(const Skyline *sky, u32 index, v2i size) {
+    if (sky->nodes[index].x + size.w > sky->size.w) return -1;
+
+    i32 y         = 0;
+    i32 widthLeft = size.w;
+    for (u32 i = index; widthLeft > 0; i++) {
+        if (i >= sky->nodeCount) return -1;
+        y = MAX(y, sky->nodes[i].y);
+        if (y + size.h > sky->size.h) return -1;
+        widthLeft -= sky->nodes[i].w;
+    }
+    return y;
+}
+
+bool SkylinePack(Skyline *sky, v2i size, v2i *pos) {
+    i32 bestIndex = -1, bestTop = INT32_MAX, bestWidth = INT32_MAX;
+    for (u32 i = 0; i < sky->nodeCount; i++) {
+        i32 y = SkylineFit(sky, i, size);
+        if (y < 0) continue;
+
+        i32 top = y + size.h;
+        if (top < bestTop || (top == bestTop && sky->nodes[i].w < bestWidth)) {
+            bestIndex = i;
+            bestTop   = top;
+            bestWidth = sky->nodes[i].w;
+        }
+    }
+    if (bestIndex < 0 || sky->nodeCount >= ATLAS_MAX_NODES) return false;
+
+    SkylineNode *nodes = sky->nodes;
+    *pos               = (v2i){nodes[bestIndex].x, bestTop - size.h};
+
+    SDL_memmove(&nodes[bestIndex + 1], &nodes[bestIndex],
+                (sky->nodeCount - bestIndex) * sizeof(SkylineNode));
+    nodes[bestIndex] = (SkylineNode){pos->x, bestTop, size.w};
+    sky->nodeCount++;
+
+    // Trim the nodes now covered by the new one
+    for (u32 i = bestIndex + 1; i < sky->nodeCount; i++) {
+        i32 overlap = nodes[i - 1].x + nodes[i - 1].w - nodes[i].x;
+        if (overlap <= 0) break;
+
+        nodes[i].x += overlap;
+        nodes[i].w -= overlap;
+        if (nodes[i].w > 0) break;
+
+        SDL_memmove(&nodes[i], &nodes[i + 1], (sky->nodeCount - i - 1) * sizeof(SkylineNode));
+        sky->nodeCount--;
+        i--;
+    }
+
+    for (u32 i = 0; i + 1 < sky->nodeCount; i++) {
+        if (nodes[i].y != nodes[i + 1].y) continue;
+        nodes[i].w += nodes[i + 1].w;
+        SDL_memmove(&nodes[i + 1], &nodes[i + 2], (sky->nodeCount - i - 2) * sizeof(SkylineNode));
+        sky->nodeCount--;
+        i--;
+    }
+
+    return true;
+}
+
+Atlas NewAtlas(v2i pageSize, i32 padding, u32 maxSprites) {
+    return (Atlas){
+        .pageSize  = pageSize,
+        .padding   = padding,
+        .sprites   = SDL_calloc(maxSprites, sizeof(AtlasSprite)),
+        .spriteMax = maxSprites,
+    };
+}
+
+intern Texture AtlasNewPage(v2i size) {
+    Texture result = {.size = size, .nChan = 4};
+
+    glGenTextures(1, &result.id);
+    glBindTexture(GL_TEXTURE_2D, result.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.w, size.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    LOG_GL_ERROR("Couldn't allocate atlas page");
+
+    return result;
+}
+
+Sprite AtlasAddPixels(Atlas *atlas, const void *rgba, v2i size) {
+    if (atlas->spriteCount >= atlas->spriteMax) {
+        LOG_ERROR("Atlas is full");
+        return (Sprite){0};
+    }
+
+    i32 pad    = atlas->padding;
+    v2i padded = {size.w + pad * 2, size.h + pad * 2};
+    v2i pos    = {0};
+
+    u32 page = 0;
+    for (; page < atlas->pageCount; page++) {
+        if (SkylinePack(&atlas->packers[page], padded, &pos)) break;
+    }
+    if (page == atlas->pageCount) {
+        if (atlas->pageCount == ATLAS_MAX_PAGES) {
+            LOG_ERROR("Atlas ran out of pages");
+            return (Sprite){0};
+        }
+        atlas->pages[page]   = AtlasNewPage(atlas->pageSize);
+        atlas->packers[page] = NewSkyline(atlas->pageSize);
+        atlas->pageCount++;
+        if (!SkylinePack(&atlas->packers[page], padded, &pos)) {
+            LOG_ERROR("Image of %dx%d doesn't fit in an atlas page", size.w, size.h);
+            return (Sprite){0};
+        }
+    }
+
+    // Extrude the border pixels into the padding so filtering never picks up a neighbour
+    const u32 *src = rgba;
+    u32       *dst = SDL_malloc(sizeof(u32) * padded.w * padded.h);
+    for (i32 y = 0; y < padded.h; y++) {
+        i32 sy = SDL_clamp(y - pad, 0, size.h - 1);
+        for (i32 x = 0; x < padded.w; x++) {
+            i32 sx                = SDL_clamp(x - pad, 0, size.w - 1);
+            dst[y * padded.w + x] = src[sy * size.w + sx];
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, atlas->pages[page].id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, padded.w, padded.h, GL_RGBA, GL_UNSIGNED_BYTE,
+                    dst);
+    LOG_GL_ERROR("Couldn't upload sprite to atlas");
+    SDL_free(dst);
+
+    v2 pageSize = {(f32)atlas->pageSize.w, (f32)atlas->pageSize.h};
+    atlas->sprites[atlas->spriteCount] = (AtlasSprite){
+        .page = page,
+        .uv   = {(pos.x + pad) / pageSize.w, (pos.y + pad) / pageSize.h, size.w / pageSize.w,
+                 size.h / pageSize.h},
+        .size = size,
+    };
+
+    return (Sprite){.id = atlas->spriteCount++};
+}
+
+Sprite AtlasAddImage(Atlas *atlas, cstr path) {
+    SDL_Surface *rgba = LoadSurface(path);
+    if (!rgba) return (Sprite){0};
+
+    Sprite result = AtlasAddPixels(atlas, rgba->pixels, (v2i){rgba->w, rgba->h});
+    SDL_DestroySurface(rgba);
+
+    return result;
+}
+
+AtlasSprite *AtlasGet(Atlas *atlas, Sprite sprite) {
+    return &atlas->sprites[sprite.id < atlas->spriteCount ? sprite.id : 0];
+}
+
+Sprite NewSprite(cstr path) {
+    return AtlasAddImage(Graphics()->atlas, path);
+}
+
+void DrawSprite(Sprite sprite, v2 pos, f32 rotation) {
+    AtlasSprite *s = AtlasGet(Graphics()->atlas, sprite);
+    DrawSpriteEx(sprite, (Rect){pos.x, pos.y, s->size.w, s->size.h}, rotation, WHITE);
+}
+
+void DrawSpriteEx(Sprite sprite, Rect dst, f32 rotation, v4 tint) {
+    Atlas       *atlas = Graphics()->atlas;
+    AtlasSprite *s     = AtlasGet(atlas, sprite);
+    BatchPush(atlas->pages[s->page].id, dst, s->uv, tint, rotation);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "engine.h"
+#include "graphics.h"
+
+#define ATLAS_MAX_PAGES 4
+#define ATLAS_MAX_NODES 512
+
+typedef struct {
+    i32 x, y, w;
+} SkylineNode;
+
+// Skyline bottom-left packer: the packed area is described by the height of its top edge
+// ("the skyline") and every new rect goes where it leaves that edge lowest.
+typedef struct {
+    v2i         size;
+    u32         nodeCount;
+    SkylineNode nodes[ATLAS_MAX_NODES];
+} Skyline;
+Skyline NewSkyline(v2i size);
+bool    SkylinePack(Skyline *sky, v2i size, v2i *pos);
+
+typedef struct {
+    u32  page;
+    Rect uv;
+    v2i  size;
+} AtlasSprite;
+
+typedef struct {
+    u32 id;
+} Sprite;
+
+typedef struct Atlas {
+    v2i          pageSize;
+    i32          padding;
+    u32          pageCount;
+    Texture      pages[ATLAS_MAX_PAGES];
+    Skyline      packers[ATLAS_MAX_PAGES];
+    AtlasSprite *sprites;
+    u32          spriteCount, spriteMax;
+} Atlas;
+Atlas        NewAtlas(v2i pageSize, i32 padding, u32 maxSprites);
+Sprite       AtlasAddPixels(Atlas *atlas, const void *rgba, v2i size);
+Sprite       AtlasAddImage(Atlas *atlas, cstr path);
+AtlasSprite *AtlasGet(Atlas *atlas, Sprite sprite);
+
+Sprite NewSprite(cstr path);
+void   DrawSprite(Sprite sprite, v2 pos, f32 rotation);
+void   DrawSpriteEx(Sprite sprite, Rect dst, f32 rotation, v4 tint);
@@ -1,55 +1,86 @@
 #include "audio.h"
+#include "pack.h"
 
-void AudioStreamCallback(void *userData, SDL_AudioStream *stream, i32 additionalAmount,
-                         i32 totalAmount) {
-    SoundBuffer *sounds = (SoundBuffer *)userData;
-
-    i32 channels   = 2; // sounds[0].spec.channels;
-    i32 frameSize  = sizeof(f32) * channels;
-    i32 frameCount = SDL_min(additionalAmount / frameSize, 2048);
-    f32 temp[4096] = {0};
+void AudioMix(SoundBuffer *sounds, u32 count, f32 *out, i32 frameCount) {
+    SDL_memset(out, 0, frameCount * MIX_FRAME_SIZE);
 
-    for (u32 i = 0; i < 64; i++) {
+    for (u32 i = 0; i < count; i++) {
         SoundBuffer *s = &sounds[i];
-        if (s->played >= s->len - frameSize && s->type == LOOPING) s->played = 0;
-        if (s->played >= s->len - frameSize && s->type != LOOPING) s->playing = false;
         if (!s->playing) continue;
+        if (s->len < MIX_FRAME_SIZE) {
+            s->playing = false;
+            continue;
+        }
 
-        i32 availableFrames = (s->len - s->played) / frameSize;
-        i32 toWrite         = SDL_min(frameCount, availableFrames);
-
-        f32 *src       = (f32 *)(s->data + s->played);
-        f32  leftGain  = s->vol * (1.0f - s->pan) * 0.5f;
-        f32  rightGain = s->vol * (1.0f + s->pan) * 0.5f;
-        leftGain       = fmaxf(0.0f, leftGain);
-        rightGain      = fmaxf(0.0f, rightGain);
-        for (i32 j = 0; j < toWrite * channels; j++) {
-            i32 id = j * channels;
-            temp[id + 0] += src[id + 0] * leftGain;
-            temp[id + 1] += src[id + 1] * rightGain;
+        if (s->culled) {
+            // Keep the cursor moving so the voice is in sync when it comes back into range
+            u64 played = s->played + (u64)frameCount * MIX_FRAME_SIZE;
+            if (played + MIX_FRAME_SIZE > s->len && s->type != LOOPING) s->playing = false;
+            u32 loopLen = s->len - s->len % MIX_FRAME_SIZE;
+            s->played   = (u32)(played % loopLen);
+            continue;
         }
 
-        s->played += toWrite * frameSize;
+        f32 leftGain  = s->gainL;
+        f32 rightGain = s->gainR;
+
+        i32 written = 0;
+        while (written < frameCount && s->playing) {
+            i32 availableFrames = (s->len - s->played) / MIX_FRAME_SIZE;
+            i32 toWrite         = SDL_min(frameCount - written, availableFrames);
+
+            f32 *src = (f32 *)(s->data + s->played);
+            f32 *dst = out + written * MIX_CHANNELS;
+            for (i32 j = 0; j < toWrite; j++) {
+                dst[j * MIX_CHANNELS + 0] += src[j * MIX_CHANNELS + 0] * leftGain;
+                dst[j * MIX_CHANNELS + 1] += src[j * MIX_CHANNELS + 1] * rightGain;
+            }
+
+            written += toWrite;
+            s->played += toWrite * MIX_FRAME_SIZE;
+
+            if (s->played + MIX_FRAME_SIZE > s->len) {
+                if (s->type == LOOPING)
+                    s->played = 0;
+                else
+                    s->playing = false;
+            }
+        }
     }
+}
 
-    SDL_CHECK(SDL_PutAudioStreamData(stream, temp, frameCount * frameSize),
+void AudioStreamCallback(void *userData, SDL_AudioStream *stream, i32 additionalAmount,
+                         i32 totalAmount) {
+    AudioCtx *audio = Audio();
+
+    i32 frameCount = SDL_min(additionalAmount / (i32)MIX_FRAME_SIZE, MIX_CHUNK_FRAMES);
+    f32 temp[MIX_CHUNK_FRAMES * MIX_CHANNELS];
+
+    u64 start = SDL_GetPerformanceCounter();
+    AudioMix(audio->sounds, audio->soundsCount, temp, frameCount);
+    audio->mixTicks += SDL_GetPerformanceCounter() - start;
+    audio->mixFrames += frameCount;
+
+    SDL_CHECK(SDL_PutAudioStreamData(stream, temp, frameCount * MIX_FRAME_SIZE),
               "Couldn't put data in audio stream");
 }
 
-AudioCtx InitAudio() {
-    AudioCtx result  = {0};
-    result.soundsMax = 64;
-    result.deviceId  = SDL_OpenAudioDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, 0);
-    result.sounds    = SDL_calloc(result.soundsMax, sizeof(SoundBuffer));
+AudioCtx InitAudio(u32 maxVoices) {
+    AudioCtx result    = {0};
+    result.soundsMax   = maxVoices + 1;
+    result.soundsCount = 1;
+    result.falloff     = 0.5f;
+    result.deviceId    = SDL_OpenAudioDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, 0);
+    result.sounds      = SDL_calloc(result.soundsMax, sizeof(SoundBuffer));
 
     SDL_AudioSpec spec = {
-        .channels = 2,
-        .format   = SDL_AUDIO_S32LE,
-        .freq     = 48000,
+        .channels = MIX_CHANNELS,
+        .format   = SDL_AUDIO_F32,
+        .freq     = MIX_FREQ,
     };
 
     result.stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec,
-                                              AudioStreamCallback, result.sounds);
+                                              AudioStreamCallback, 0);
     SDL_CHECK(result.stream, "Couldn't open audio device stream");
     SDL_CHECK(SDL_GetAudioStreamFormat(result.stream, &result.srcSpec, &result.dstSpec),
               "Couldn't format audio stream");
@@ -58,35 +89,223 @@ AudioCtx InitAudio() {
     return result;
 }
 
+AudioCtx InitAudioOffline(u32 maxVoices, u32 sinkFrames) {
+    AudioCtx result    = {0};
+    result.offline     = true;
+    result.soundsMax   = maxVoices + 1;
+    result.soundsCount = 1;
+    result.falloff     = 0.5f;
+    result.sounds      = SDL_calloc(result.soundsMax, sizeof(SoundBuffer));
+    result.srcSpec     = (SDL_AudioSpec){
+        .channels = MIX_CHANNELS,
+        .format   = SDL_AUDIO_F32,
+        .freq     = MIX_FREQ,
+    };
+    result.dstSpec = result.srcSpec;
+
+    result.sink.framesMax = sinkFrames;
+    result.sink.samples   = SDL_calloc(sinkFrames, MIX_FRAME_SIZE);
+
+    return result;
+}
+
+intern void SoundUpdateGains(SoundBuffer *buf, f32 vol, f32 pan) {
+    buf->gainL = fmaxf(0.0f, vol * (1.0f - pan) * 0.5f);
+    buf->gainR = fmaxf(0.0f, vol * (1.0f + pan) * 0.5f);
+}
+
+void AudioSetListener(Camera cam) {
+    Audio()->listener = cam;
+}
+
+void UpdateAudio(AudioCtx *audio, v2 res) {
+    Camera listener = audio->listener;
+    f32    scale    = CameraScale(listener);
+    v2     halfView = v2Scale(res, 0.5f / scale);
+    v2     center   = v2Add(listener.pos, v2Scale(res, 0.5f));
+    f32    c        = cosf(-listener.rotation);
+    f32    s        = sinf(-listener.rotation);
+    f32    falloff  = fmaxf(audio->falloff * halfView.w * 2, 1.0f);
+    if (halfView.w <= 0 || halfView.h <= 0) return; // Headless without a resolution
+
+    // The device callback reads the gains while it mixes
+    if (audio->stream) SDL_LockAudioStream(audio->stream);
+    for (u32 i = 0; i < audio->soundsCount; i++) {
+        SoundBuffer *buf = &audio->sounds[i];
+        if (!buf->playing || !buf->spatial) continue;
+
+        v2 rel   = v2Sub(buf->pos, center);
+        v2 local = {rel.x * c - rel.y * s, rel.x * s + rel.y * c};
+
+        f32 outX    = fmaxf(f32Abs(local.x) - halfView.w, 0.0f);
+        f32 outY    = fmaxf(f32Abs(local.y) - halfView.h, 0.0f);
+        f32 atten   = 1.0f - sqrtf(outX * outX + outY * outY) / falloff;
+
+        buf->culled = atten <= 0.0f;
+        if (buf->culled) continue;
+
+        f32 pan = SDL_clamp(local.x / halfView.w + buf->pan, -1.0f, 1.0f);
+        SoundUpdateGains(buf, buf->vol * atten, pan);
+    }
+    if (audio->stream) SDL_UnlockAudioStream(audio->stream);
+}
+
 void ShutdownAudio(AudioCtx *audio) {
-    SDL_DestroyAudioStream(Audio()->stream);
-    SDL_free(Audio()->sounds);
+    if (audio->offline) {
+        AudioSinkClose(&audio->sink);
+        SDL_free(audio->sink.samples);
+    } else {
+        SDL_DestroyAudioStream(audio->stream);
+    }
+    SDL_free(audio->sounds);
+}
+
+void AudioRenderFrames(AudioCtx *audio, u32 frames) {
+    if (!audio->offline) {
+        LOG_WARNING("Audio is being rendered by the device");
+        return;
+    }
+
+    AudioSink *sink = &audio->sink;
+    while (frames > 0) {
+        if (sink->frames == sink->framesMax) {
+            if (!sink->file) {
+                if (!sink->dropping) LOG_WARNING("Audio sink is full, dropping what's rendered");
+                sink->dropping = true;
+                return;
+            }
+            AudioSinkFlush(sink);
+        }
+
+        u32 toMix = SDL_min(SDL_min(frames, sink->framesMax - sink->frames), MIX_CHUNK_FRAMES);
+        u64 start = SDL_GetPerformanceCounter();
+        AudioMix(audio->sounds, audio->soundsCount, sink->samples + sink->frames * MIX_CHANNELS,
+                 toMix);
+        audio->mixTicks += SDL_GetPerformanceCounter() - start;
+        audio->mixFrames += toMix;
+
+        sink->frames += toMix;
+        frames -= toMix;
+    }
+}
+
+intern void AudioSinkWriteHeader(SDL_IOStream *io, u64 frames) {
+    u32 dataSize = (u32)(frames * MIX_FRAME_SIZE);
+    SDL_WriteIO(io, "RIFF", 4);
+    SDL_WriteU32LE(io, 36 + dataSize);
+    SDL_WriteIO(io, "WAVEfmt ", 8);
+    SDL_WriteU32LE(io, 16);
+    SDL_WriteU16LE(io, 3); // IEEE float
+    SDL_WriteU16LE(io, MIX_CHANNELS);
+    SDL_WriteU32LE(io, MIX_FREQ);
+    SDL_WriteU32LE(io, MIX_FREQ * MIX_FRAME_SIZE);
+    SDL_WriteU16LE(io, MIX_FRAME_SIZE);
+    SDL_WriteU16LE(io, sizeof(f32) * 8);
+    SDL_WriteIO(io, "data", 4);
+    SDL_WriteU32LE(io, dataSize);
+}
+
+bool AudioSinkOpenWav(AudioSink *sink, cstr path) {
+    AudioSinkClose(sink);
+
+    sink->file = SDL_IOFromFile(path, "wb");
+    if (!sink->file) {
+        LOG_ERROR("Couldn't open %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    sink->fileFrames = 0;
+    sink->dropping   = false;
+    AudioSinkWriteHeader(sink->file, 0);
+    return true;
+}
+
+void AudioSinkFlush(AudioSink *sink) {
+    if (!sink->file || sink->frames == 0) return;
+
+    SDL_WriteIO(sink->file, sink->samples, sink->frames * MIX_FRAME_SIZE);
+    sink->fileFrames += sink->frames;
+    sink->frames = 0;
+}
+
+void AudioSinkClose(AudioSink *sink) {
+    if (!sink->file) return;
+
+    AudioSinkFlush(sink);
+    SDL_SeekIO(sink->file, 0, SDL_IO_SEEK_SET);
+    AudioSinkWriteHeader(sink->file, sink->fileFrames);
+    SDL_CloseIO(sink->file);
+    sink->file = 0;
 }
 
 Sound NewSound(cstr path, PlaybackType type) {
+    // Reuse voices freed by SoundFree before growing the list
+    u32 id = 1;
+    while (id < Audio()->soundsCount && Audio()->sounds[id].data) id++;
+    if (id >= Audio()->soundsMax) {
+        LOG_ERROR("Too many sounds loaded, can't load %s", path);
+        return (Sound){0};
+    }
+
     SoundBuffer result = {
         .type = type,
         .vol  = 1.0f,
     };
+    SoundUpdateGains(&result, result.vol, result.pan);
 
-    if (!SDL_LoadWAV(path, &result.spec, &result.data, &result.len)) {
-        LOG_ERROR("Loading file failed: %s", "data\\test.wav", SDL_GetError());
-        return (Sound){0};
+    // Packed sounds are already in the mixing format and get played straight from the mapping
+    const PackEntry *entry = PackFind(Pack(), path);
+    if (entry && entry->type == PACK_SOUND) {
+        result.data = (u8 *)PackData(Pack(), entry);
+        result.len  = (u32)entry->len;
+    } else {
+        u8 *wav    = 0;
+        u32 wavLen = 0;
+        if (!SDL_LoadWAV(path, &result.spec, &wav, &wavLen)) {
+            LOG_ERROR("Loading file %s failed: %s", path, SDL_GetError());
+            return (Sound){0};
+        }
+
+        i32 mixLen = 0;
+        if (!SDL_ConvertAudioSamples(&result.spec, wav, (i32)wavLen, &Audio()->srcSpec,
+                                     &result.data, &mixLen)) {
+            LOG_ERROR("Couldn't convert %s to the mixing format: %s", path, SDL_GetError());
+            SDL_free(wav);
+            return (Sound){0};
+        }
+        SDL_free(wav);
+        result.len = (u32)mixLen;
+    }
+    result.spec = Audio()->srcSpec;
+
+    if (!Audio()->offline) {
+        result.audioStream = SDL_CreateAudioStream(&result.spec, 0);
+        if (!result.audioStream) LOG_ERROR("Failed to create audio stream: %s", SDL_GetError());
+        if (!SDL_BindAudioStream(Audio()->deviceId, result.audioStream))
+            LOG_ERROR("Failed to bind audio stream: %s", SDL_GetError());
     }
 
-    result.audioStream = SDL_CreateAudioStream(&result.spec, 0);
-    if (!result.audioStream) LOG_ERROR("Failed to create audio stream: %s", SDL_GetError());
-    if (!SDL_BindAudioStream(Audio()->deviceId, result.audioStream))
-        LOG_ERROR("Failed to bind audio stream: %s", SDL_GetError());
+    Audio()->sounds[id] = result;
+    if (id == Audio()->soundsCount) Audio()->soundsCount++;
 
-    Audio()->sounds[Audio()->soundsCount] = result;
+    return (Sound){.id = id};
+}
+
+void SoundFree(Sound sound) {
+    AudioCtx    *audio = Audio();
+    SoundBuffer *buf   = &audio->sounds[sound.id];
 
-    return (Sound){.id = Audio()->soundsCount++};
+    // The device callback may be mixing this voice right now
+    if (audio->stream) SDL_LockAudioStream(audio->stream);
+    if (buf->audioStream) SDL_DestroyAudioStream(buf->audioStream);
+    FreeAsset((string){.data = (cstr)buf->data, .len = buf->len});
+    *buf = (SoundBuffer){0};
+    if (audio->stream) SDL_UnlockAudioStream(audio->stream);
 }
 
 void SoundPlay(Sound sound) {
     SoundBuffer *buf = &Audio()->sounds[sound.id];
-    SDL_ClearAudioStream(buf->audioStream);
+    if (buf->audioStream) SDL_ClearAudioStream(buf->audioStream);
     buf->playing = true;
     buf->played  = 0;
 }
@@ -98,7 +317,7 @@ void SoundPause(Sound sound) {
 
 void SoundStop(Sound sound) {
     SoundBuffer *buf = &Audio()->sounds[sound.id];
-    SDL_ClearAudioStream(buf->audioStream);
+    if (buf->audioStream) SDL_ClearAudioStream(buf->audioStream);
     buf->played = 0;
 }
 
@@ -110,9 +329,24 @@ void SoundResume(Sound sound) {
 void SoundSetPan(Sound sound, f32 pan) {
     SoundBuffer *buf = &Audio()->sounds[sound.id];
     buf->pan         = pan;
+    if (!buf->spatial) SoundUpdateGains(buf, buf->vol, buf->pan);
 }
 
 void SoundSetVol(Sound sound, f32 vol) {
     SoundBuffer *buf = &Audio()->sounds[sound.id];
     buf->vol         = vol;
-}
\ No newline at end of file
+    if (!buf->spatial) SoundUpdateGains(buf, buf->vol, buf->pan);
+}
+
+void SoundSetPos(Sound sound, v2 pos) {
+    SoundBuffer *buf = &Audio()->sounds[sound.id];
+    buf->pos         = pos;
+    if (!buf->spatial) SoundSetSpatial(sound, true);
+}
+
+void SoundSetSpatial(Sound sound, bool spatial) {
+    SoundBuffer *buf = &Audio()->sounds[sound.id];
+    buf->spatial     = spatial;
+    buf->culled      = false;
+    if (!spatial) SoundUpdateGains(buf, buf->vol, buf->pan);
+}
@@ -1,6 +1,13 @@
 #pragma once
 
 #include "engine.h"
+#include "graphics.h"
+
+// Every sound is converted to this format on load, so the mixer never resamples.
+#define MIX_CHANNELS 2
+#define MIX_FREQ 48000
+#define MIX_FRAME_SIZE (sizeof(f32) * MIX_CHANNELS)
+#define MIX_CHUNK_FRAMES 2048
 
 typedef enum { ONESHOT, LOOPING, HELD } PlaybackType;
 
@@ -10,21 +17,40 @@ typedef struct SoundBuffer {
     u8              *data;
     u32              len, played;
     f32              vol, pan;
+    f32              gainL, gainR;
+    v2               pos;
     PlaybackType     type;
-    bool             playing;
+    bool             playing, spatial, culled;
 } SoundBuffer;
 
+// Voice 0 stays silent and is what NewSound returns when loading fails
 typedef struct Sound {
     u32 id;
 } Sound;
 
 Sound NewSound(cstr path, PlaybackType type);
+void  SoundFree(Sound sound);
 void  SoundPlay(Sound sound);
 void  SoundPause(Sound sound);
 void  SoundStop(Sound sound);
 void  SoundResume(Sound sound);
 void  SoundSetPan(Sound sound, f32 pan);
 void  SoundSetVol(Sound sound, f32 vol);
+void  SoundSetPos(Sound sound, v2 pos);
+void  SoundSetSpatial(Sound sound, bool spatial);
+
+// Destination for offline rendering. Mixed frames accumulate in memory and, if a file is
+// open, get flushed to it as a float WAV whenever the buffer fills up.
+typedef struct {
+    f32          *samples;
+    u32           frames, framesMax;
+    SDL_IOStream *file;
+    u64           fileFrames;
+    bool          dropping; // Full with no file, warned about once
+} AudioSink;
+bool AudioSinkOpenWav(AudioSink *sink, cstr path);
+void AudioSinkFlush(AudioSink *sink);
+void AudioSinkClose(AudioSink *sink);
 
 typedef struct {
     SDL_AudioDeviceID deviceId;
@@ -32,7 +58,19 @@ typedef struct {
     SDL_AudioSpec     srcSpec, dstSpec;
     SoundBuffer      *sounds;
     u32               soundsMax, soundsCount;
+
+    bool      offline;
+    AudioSink sink;
+    u64       mixTicks, mixFrames;
+
+    f32    falloff;  // Distance outside the view, in view widths, until a spatial voice is silent
+    Camera listener; // Spatial voices are heard from its view
 } AudioCtx;
-AudioCtx  InitAudio();
+AudioCtx  InitAudio(u32 maxVoices);
+AudioCtx  InitAudioOffline(u32 maxVoices, u32 sinkFrames);
+void      UpdateAudio(AudioCtx *audio, v2 res);
+void      AudioSetListener(Camera cam); // The camera the game draws with, set every Update
 void      ShutdownAudio(AudioCtx *audio);
-AudioCtx *Audio();
\ No newline at end of file
+void      AudioMix(SoundBuffer *sounds, u32 count, f32 *out, i32 frameCount);
+void      AudioRenderFrames(AudioCtx *audio, u32 frames);
+AudioCtx *Audio();
@@ -34,41 +34,61 @@ Arena NewArena(void *memory, u64 size) {
     return (Arena){.buf = memory, .used = 0, .size = size};
 }
 
+intern u64 ArenaAligned(u64 offset) {
+    return (offset + ARENA_ALIGN - 1) & ~(u64)(ARENA_ALIGN - 1);
+}
+
 void *Alloc(Arena *arena, u64 size) {
-    if (arena->used + size >= arena->size) {
-        LOG_ERROR("Arena is full");
+    u64 start = ArenaAligned(arena->used);
+    if (start + size > arena->size) {
+        LOG_ERROR("Arena is full, %llu of %llu bytes used", arena->used, arena->size);
         return 0;
     }
 
-    void *result = (void *)(&arena->buf[arena->used]);
-    arena->used += size;
-    return result;
+    arena->last = start;
+    arena->used = start + size;
+    return &arena->buf[start];
 }
 
 void *RingAlloc(Arena *arena, u64 size) {
-    if (arena->used + size >= arena->size) {
-        arena->used = 0;
+    if (size > arena->size) {
+        LOG_ERROR("Allocation of %llu bytes is larger than the ring", size);
+        return 0;
     }
 
-    void *result = (void *)(&arena->buf[arena->used]);
-    arena->used += size;
-    return result;
+    if (ArenaAligned(arena->used) + size > arena->size) {
+        LOG_WARNING("Ring wrapped around, its oldest allocations get overwritten");
+        arena->used = 0;
+    }
+    return Alloc(arena, size);
 }
 
 void DeAlloc(Arena *arena, void *ptr) {
-    i64 ptrDiff = (u8 *)ptr - arena->buf;
-
-    // TODO is this correct?
-    if (ptrDiff < 0 || ptrDiff >= (u64)arena->buf + arena->size) {
+    u8 *at = ptr;
+    if (at < arena->buf || at >= arena->buf + arena->used) {
         LOG_ERROR("Pointer is not in arena");
         return;
     }
 
-    arena->used = ptrDiff;
+    if (at == arena->buf + arena->last) arena->used = arena->last;
 }
 
 void Empty(Arena *arena) {
     arena->used = 0;
+    arena->last = 0;
+}
+
+ArenaMark ArenaSave(Arena *arena) {
+    return (ArenaMark){arena, arena->used};
+}
+
+void ArenaRestore(ArenaMark mark) {
+    if (mark.used > mark.arena->used) {
+        LOG_ERROR("Mark is past the arena's end, it was restored out of order");
+        return;
+    }
+    mark.arena->used = mark.used;
+    mark.arena->last = MIN(mark.arena->last, mark.used);
 }
 
 u32 SimpleHash(cstr str) {
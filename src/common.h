@@ -3,6 +3,7 @@
 #include <float.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <time.h>
@@ -131,16 +132,28 @@ typedef struct {
     u32 count;
 } Poly;
 
+// Allocations are ARENA_ALIGN aligned. DeAlloc only gives back the most recent one, anything
+// else is reclaimed by Empty or by restoring a mark from before it.
+#define ARENA_ALIGN 16
+
 typedef struct {
     u8 *buf;
     u64 used, size;
+    u64 last; // Offset of the most recent allocation
 } Arena;
 Arena NewArena(void *memory, u64 size);
 void *Alloc(Arena *arena, u64 size);
-void *RingAlloc(Arena *arena, u64 size);
+void *RingAlloc(Arena *arena, u64 size); // Wraps to the start when full, over the oldest data
 void  DeAlloc(Arena *arena, void *ptr);
 void  Empty(Arena *arena);
 
+typedef struct {
+    Arena *arena;
+    u64    used;
+} ArenaMark;
+ArenaMark ArenaSave(Arena *arena);
+void      ArenaRestore(ArenaMark mark); // Frees everything allocated since the mark
+
 // ===== MATH =====
 
 #define MAX(a, b) (a >= b ? a : b)
@@ -182,6 +195,25 @@ inline f32 Length(v2 vec) {
 
 v2 CollisionNormal(Rect rectA, Rect rectB);
 
+// 2D affine transform, column-major like a GLSL mat3. The last row is always 0, 0, 1.
+typedef struct {
+    f32 m[9];
+} m3;
+
+inline v2 m3MulV2(m3 a, v2 p) {
+    return (v2){a.m[0] * p.x + a.m[3] * p.y + a.m[6], a.m[1] * p.x + a.m[4] * p.y + a.m[7]};
+}
+
+inline m3 m3Inverse(m3 a) {
+    f32 det = a.m[0] * a.m[4] - a.m[3] * a.m[1];
+    if (det == 0.0f) return (m3){0};
+
+    f32 inv = 1.0f / det;
+    f32 xx = a.m[4] * inv, xy = -a.m[1] * inv, yx = -a.m[3] * inv, yy = a.m[0] * inv;
+    return (m3){{xx, xy, 0, yx, yy, 0, -(xx * a.m[6] + yx * a.m[7]), -(xy * a.m[6] + yy * a.m[7]),
+                 1}};
+}
+
 inline v2 MoveBy(v2 a, v2 b, f32 amount) {
     v2  to   = (v2){b.x - a.x, b.y - a.y};
     f32 dist = Distance(a, b);
@@ -345,13 +377,13 @@ inline void Log(LogLevel level, cstr ctx, cstr msg, ...) {
 #if LOG_LEVEL <= 0
 #define LOG_INFO(msg, ...) Log(LEVEL_INFO, __func__, msg, ##__VA_ARGS__)
 #else
-#define LOG_INFO(msg)
+#define LOG_INFO(msg, ...)
 #endif
 
 #if LOG_LEVEL <= 1
 #define LOG_WARNING(msg, ...) Log(LEVEL_WARNING, __func__, msg, ##__VA_ARGS__)
 #else
-#define LOG_WARNING(msg)
+#define LOG_WARNING(msg, ...)
 #endif
 
 #if LOG_LEVEL <= 2
@@ -366,7 +398,7 @@ inline void Log(LogLevel level, cstr ctx, cstr msg, ...) {
         if (!func) LOG_ERROR(msg ": %s", SDL_GetError());                                          \
     } while (0);
 #else
-#define LOG_ERROR(msg)
+#define LOG_ERROR(msg, ...)
 #define LOG_GL_ERROR(msg)
 #define SDL_CHECK(func, msg) (func)
 #endif
@@ -382,6 +414,6 @@ inline void Log(LogLevel level, cstr ctx, cstr msg, ...) {
         if (!func) LOG_FATAL(msg ": %s", SDL_GetError());                                          \
     } while (0);
 #else
-#define LOG_FATAL(msg)
+#define LOG_FATAL(msg, ...)
 #define SDL_FATAL(func, msg) (func)
 #endif
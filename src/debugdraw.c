@@ -0,0 +1,153 @@
+#include "debugdraw.h"
+#include "text.h"
+
+#ifdef DEBUG
+DebugDraw NewDebugDraw() {
+    DebugDraw result = {
+        .segments = SDL_malloc(DEBUG_MAX_LINES * sizeof(DebugSegment)),
+        .labels   = SDL_malloc(DEBUG_MAX_LABELS * sizeof(DebugLabel)),
+        .shader   = ShaderFromPath("shaders\\color.vert", "shaders\\color.frag"),
+    };
+
+    glGenVertexArrays(1, &result.vao);
+    glBindVertexArray(result.vao);
+    {
+        result.stream = NewStreamBuffer(sizeof(DebugVertex), DEBUG_MAX_LINES * 2);
+
+        u32 stride = sizeof(DebugVertex);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(DebugVertex, pos));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(DebugVertex, color));
+    }
+    glBindVertexArray(0);
+
+    return result;
+}
+
+void DebugLine(v2 from, v2 to, v4 color, f32 duration) {
+    DebugDraw *debug = Graphics()->debug;
+    if (debug->segmentCount == DEBUG_MAX_LINES) return;
+
+    debug->segments[debug->segmentCount++] = (DebugSegment){from, to, color, duration};
+}
+
+void DebugArrow(v2 from, v2 to, v4 color, f32 duration) {
+    v2  dir = v2Sub(to, from);
+    f32 len = Length(dir);
+    if (len <= 0) return;
+
+    // The head is a quarter of the arrow, up to 16 units
+    v2 back = v2Scale(dir, -MIN(len * 0.25f, 16.0f) / len);
+    v2 side = {-back.y * 0.5f, back.x * 0.5f};
+    DebugLine(from, to, color, duration);
+    DebugLine(to, v2Add(to, v2Add(back, side)), color, duration);
+    DebugLine(to, v2Sub(v2Add(to, back), side), color, duration);
+}
+
+void DebugRect(Rect rect, v4 color, f32 duration) {
+    v2 corners[4] = {
+        {rect.x, rect.y},
+        {rect.x + rect.w, rect.y},
+        {rect.x + rect.w, rect.y + rect.h},
+        {rect.x, rect.y + rect.h},
+    };
+    for (u32 i = 0; i < 4; i++) DebugLine(corners[i], corners[(i + 1) % 4], color, duration);
+}
+
+void DebugCircle(v2 center, f32 radius, v4 color, f32 duration) {
+    v2 last = {center.x + radius, center.y};
+    for (u32 i = 1; i <= DEBUG_CIRCLE_SEGMENTS; i++) {
+        f32 angle = TAU * i / DEBUG_CIRCLE_SEGMENTS;
+        v2  next  = {center.x + radius * cosf(angle), center.y + radius * sinf(angle)};
+        DebugLine(last, next, color, duration);
+        last = next;
+    }
+}
+
+void DebugPoly(Poly poly, v4 color, f32 duration) {
+    for (u32 i = 0; i + 1 < poly.count; i++)
+        DebugLine(poly.verts[i], poly.verts[i + 1], color, duration);
+}
+
+void DebugText(v2 pos, v4 color, f32 duration, cstr fmt, ...) {
+    DebugDraw *debug = Graphics()->debug;
+    if (debug->labelCount == DEBUG_MAX_LABELS) return;
+
+    DebugLabel *label = &debug->labels[debug->labelCount++];
+    *label            = (DebugLabel){.pos = pos, .color = color, .remaining = duration};
+
+    va_list args;
+    va_start(args, fmt);
+    SDL_vsnprintf(label->text, sizeof(label->text), fmt, args);
+    va_end(args);
+}
+
+void DebugPass(const RenderPass *pass) {
+    DebugDraw *debug = Graphics()->debug;
+    Camera     cam   = Graphics()->sceneCam;
+
+    if (debug->segmentCount) {
+        u32 first = StreamBase(&debug->stream) + debug->stream.used;
+        u32 count = 0;
+        for (u32 i = 0; i < debug->segmentCount; i++) {
+            DebugVertex *from = StreamPush(&debug->stream);
+            DebugVertex *to   = StreamPush(&debug->stream);
+            if (!from || !to) break;
+
+            DebugSegment segment = debug->segments[i];
+            *from                = (DebugVertex){segment.from, segment.color};
+            *to                  = (DebugVertex){segment.to, segment.color};
+            count += 2;
+        }
+
+        CameraBegin(cam);
+        ShaderUse(debug->shader);
+        glBindVertexArray(debug->vao);
+        LOG_GL_ERROR("VAO binding failed");
+        {
+            glDrawArrays(GL_LINES, (i32)first, (i32)count);
+            LOG_GL_ERROR("Drawing failed");
+        }
+        glBindVertexArray(0);
+        CameraEnd();
+    }
+
+    // Labels stay readable whatever the zoom, so they're placed in screen space
+    Font *font = debug->labelCount ? GetFont(DEBUG_FONT, DEBUG_FONT_SIZE) : 0;
+    for (u32 i = 0; i < debug->labelCount; i++) {
+        DebugLabel *label = &debug->labels[i];
+        DrawTextEx(font, label->text, WorldToScreen(cam, label->pos), label->color, 0);
+    }
+}
+
+// Reading the window makes it run after every other pass drawing to it
+void AddDebugPass(RenderGraph *graph) {
+    RenderGraphPass(graph, (RenderPass){
+        .name   = "debug",
+        .kind   = PASS_DEBUG,
+        .inputs = {RT_WINDOW},
+        .output = RT_WINDOW,
+    });
+}
+
+void UpdateDebugDraw(DebugDraw *debug) {
+    f32 delta = Delta();
+    StreamAdvance(&debug->stream);
+
+    u32 kept = 0;
+    for (u32 i = 0; i < debug->segmentCount; i++) {
+        debug->segments[i].remaining -= delta;
+        if (debug->segments[i].remaining > 0) debug->segments[kept++] = debug->segments[i];
+    }
+    debug->segmentCount = kept;
+
+    kept = 0;
+    for (u32 i = 0; i < debug->labelCount; i++) {
+        debug->labels[i].remaining -= delta;
+        if (debug->labels[i].remaining > 0) debug->labels[kept++] = debug->labels[i];
+    }
+    debug->labelCount = kept;
+}
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "engine.h"
+#include "graphics.h"
+#include "rendergraph.h"
+
+// Debug shapes can be added from anywhere during the frame, in world coordinates. They're drawn
+// over the final image by the "debug" pass: every line in one GL_LINES draw, then the labels
+// through the sprite batch at a fixed pixel size. A shape stays up for duration seconds, or
+// for one frame when that's 0. Release builds compile the calls out, arguments included.
+#define DEBUG_MAX_LINES 65536
+#define DEBUG_MAX_LABELS 256
+#define DEBUG_LABEL_MAX 64
+#define DEBUG_CIRCLE_SEGMENTS 24
+#define DEBUG_FONT "data\\jetbrains.ttf"
+#define DEBUG_FONT_SIZE 12
+
+#ifdef DEBUG
+typedef struct {
+    v2  from, to;
+    v4  color;
+    f32 remaining; // Seconds
+} DebugSegment;
+
+typedef struct {
+    v2   pos;
+    v4   color;
+    f32  remaining;
+    char text[DEBUG_LABEL_MAX];
+} DebugLabel;
+
+typedef struct {
+    v2 pos;
+    v4 color;
+} DebugVertex;
+
+struct DebugDraw {
+    DebugSegment *segments; // DEBUG_MAX_LINES
+    u32           segmentCount;
+    DebugLabel   *labels; // DEBUG_MAX_LABELS
+    u32           labelCount;
+    u32           vao;
+    StreamBuffer  stream;
+    Shader        shader;
+};
+DebugDraw NewDebugDraw();
+void      AddDebugPass(RenderGraph *graph);
+void      UpdateDebugDraw(DebugDraw *debug); // Ages the shapes, at the end of the frame
+
+void DebugLine(v2 from, v2 to, v4 color, f32 duration);
+void DebugArrow(v2 from, v2 to, v4 color, f32 duration);
+void DebugRect(Rect rect, v4 color, f32 duration);
+void DebugCircle(v2 center, f32 radius, v4 color, f32 duration);
+void DebugPoly(Poly poly, v4 color, f32 duration);
+void DebugText(v2 pos, v4 color, f32 duration, cstr fmt, ...);
+#else
+#define DebugLine(from, to, color, duration)
+#define DebugArrow(from, to, color, duration)
+#define DebugRect(rect, color, duration)
+#define DebugCircle(center, radius, color, duration)
+#define DebugPoly(poly, color, duration)
+#define DebugText(pos, color, duration, fmt, ...)
+#endif
@@ -1,19 +1,36 @@
 #include "engine.h"
 
+#include "animation.c"
+#include "assets.c"
+#include "atlas.c"
 #include "audio.c"
 #include "common.c"
+#include "debugdraw.c"
 #include "graphics.c"
 #include "gui.c"
 #include "input.c"
+#include "lights.c"
+#include "pack.c"
+#include "particles.c"
+#include "rendergraph.c"
+#include "tessellate.c"
+#include "text.c"
+#include "tilemap.c"
+#include "watcher.c"
 
 struct EngineCtx {
     Arena        Memory;
+    Arena        Frames[2];
+    u32          frame; // Index of this frame's arena
     GameSettings Settings;
+    PackCtx      Pack;
     InputCtx     Input;
     TimingCtx    Timing;
     WindowCtx    Window;
     AudioCtx     Audio;
+    AssetsCtx    Assets;
     GraphicsCtx  Graphics;
+    WatcherCtx   Watcher;
     GameCode     Game;
 };
 
@@ -32,15 +49,34 @@ GraphicsCtx *Graphics() {
 AudioCtx *Audio() {
     return &E->Audio;
 }
+AssetsCtx *Assets() {
+    return &E->Assets;
+}
 TimingCtx *Timing() {
     return &E->Timing;
 }
 GameSettings *Settings() {
     return &E->Settings;
 }
+PackCtx *Pack() {
+    return &E->Pack;
+}
 Arena *Memory() {
     return &E->Memory;
 }
+Arena *FrameArena() {
+    return &E->Frames[E->frame];
+}
+
+void *FrameAlloc(u64 size) {
+    return Alloc(FrameArena(), size);
+}
+ArenaMark ScratchBegin() {
+    return ArenaSave(FrameArena());
+}
+void ScratchEnd(ArenaMark mark) {
+    ArenaRestore(mark);
+}
 
 f32 Delta() {
     return Timing()->delta;
@@ -65,25 +101,71 @@ export void EngineLoadGame(void (*setup)(), void (*init)(), void (*update)(), vo
 export void EngineInit() {
     SDL_srand(0);
 
+    S = (GameState *)((u8 *)E + sizeof(EngineCtx));
+    SDL_memset(S, 0, GAME_STATE_SIZE);
     E->Game.Setup();
-    E->Memory   = NewArena((void *)((u8 *)E + sizeof(EngineCtx)), 128 * 1000000);
-    E->Window   = InitWindow(Settings());
-    E->Graphics = InitGraphics(&E->Window, &E->Settings);
-    E->Audio    = InitAudio();
-    E->Timing   = InitTiming(SDL_GetCurrentDisplayMode(SDL_GetDisplays(0)[0])->refresh_rate);
-    E->Input    = InitInput();
+
+    u8 *memory   = (u8 *)S + GAME_STATE_SIZE;
+    u64 size     = ENGINE_MEMORY_SIZE - sizeof(EngineCtx) - GAME_STATE_SIZE - FRAME_ARENA_SIZE * 2;
+    E->Memory    = NewArena(memory, size);
+    E->Frames[0] = NewArena(memory + size, FRAME_ARENA_SIZE);
+    E->Frames[1] = NewArena(memory + size + FRAME_ARENA_SIZE, FRAME_ARENA_SIZE);
+
+#ifndef DEBUG
+    // Debug builds read loose files so edits to data/ and shaders/ show up without repacking
+    E->Pack = InitPack(PACK_DEFAULT_PATH);
+#endif
+    if (Settings()->headless) {
+        // Input, window and graphics stay zeroed, and nothing polls or draws them
+        Settings()->offlineAudio = true;
+    } else {
+        E->Window   = InitWindow(Settings());
+        E->Graphics = InitGraphics(&E->Window, &E->Settings);
+        E->Input    = InitInput();
+    }
+    u32 voices = MAX(Settings()->audioVoices, 64);
+    E->Audio   = Settings()->offlineAudio ? InitAudioOffline(voices, MIX_FREQ * 10)
+                                          : InitAudio(voices);
+    E->Assets  = InitAssets(Settings()->assetBudget ? Settings()->assetBudget
+                                                    : ASSET_DEFAULT_BUDGET);
+    if (Settings()->offlineAudio) {
+        E->Timing            = InitTiming(OFFLINE_UPDATE_RATE);
+        E->Timing.fixedDelta = 1.0f / OFFLINE_UPDATE_RATE;
+        if (Settings()->headless) E->Timing.targetSpf = 0; // As fast as it goes
+    } else {
+        E->Timing = InitTiming(SDL_GetCurrentDisplayMode(SDL_GetDisplays(0)[0])->refresh_rate);
+    }
+#ifdef DEBUG
+    if (!Settings()->headless) {
+        E->Watcher = InitWatcher();
+        StartWatcher(&E->Watcher);
+    }
+#endif
 
     E->Game.Init();
 }
 
 export void EngineUpdate() {
-    UpdateInput(&E->Input);
+    E->frame ^= 1;
+    Empty(FrameArena());
+
+    bool headless = Settings()->headless;
+    if (!headless) UpdateInput(&E->Input);
     UpdateTiming(&E->Timing);
+#ifdef DEBUG
+    if (!headless) UpdateWatcher(&E->Watcher);
+#endif
 
     E->Game.Update();
+    UpdateAudio(Audio(), GetResolution());
+    if (Audio()->offline) AudioRenderFrames(Audio(), MIX_FREQ / OFFLINE_UPDATE_RATE);
+
+    if (!headless) UpdateGraphics(&E->Graphics, E->Game.Draw);
+    UpdateAssets(&E->Assets);
+    if (!headless) UpdateWindow(&E->Window);
 
-    UpdateGraphics(&E->Graphics, E->Game.Draw);
-    UpdateWindow(&E->Window);
+    u32 limit = Settings()->headlessUpdates;
+    if (headless && limit && E->Timing.updates >= limit) Window()->quit = true;
 }
 
 export void EngineReloadMemory(void *memory) {
@@ -95,10 +177,15 @@ export void EngineReloadMemory(void *memory) {
 }
 
 export void EngineShutdown() {
+    ShutdownWatcher(&E->Watcher);
+    ShutdownAssets(Assets());
     ShutdownAudio(Audio());
-    if (!SDL_GL_DestroyContext(Window()->glCtx))
-        LOG_ERROR("Error destroying context: %s", SDL_GetError());
-    SDL_DestroyWindow(Window()->window);
+    ShutdownPack(Pack());
+    if (Window()->window) {
+        if (!SDL_GL_DestroyContext(Window()->glCtx))
+            LOG_ERROR("Error destroying context: %s", SDL_GetError());
+        SDL_DestroyWindow(Window()->window);
+    }
     SDL_Quit();
 }
 
@@ -109,6 +196,10 @@ export void *EngineGetMemory() {
         LOG_FATAL("Engine context not loaded");
 }
 
+export u64 EngineMemorySize() {
+    return ENGINE_MEMORY_SIZE;
+}
+
 export bool EngineIsRunning() {
     return !Window()->quit;
 }
@@ -127,8 +218,9 @@ WindowCtx InitWindow(const GameSettings *settings) {
     SDL_FATAL(SDL_SetWindowPosition(buffer.window, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED),
               "Failed to set window position");
     // SDL_FATAL(SDL_SetWindowFullscreen(buffer.window, true), "Failed to fullscreen window");
-    SDL_FATAL(SDL_SetWindowIcon(buffer.window, IMG_Load("data\\icon.ico")),
-              "Failed to set window icon");
+    SDL_Surface *icon = LoadSurface("data\\icon.ico");
+    SDL_FATAL(SDL_SetWindowIcon(buffer.window, icon), "Failed to set window icon");
+    SDL_DestroySurface(icon);
 
     buffer.glCtx = SDL_GL_CreateContext(buffer.window);
     SDL_FATAL(buffer.glCtx, "Failed to create context");
@@ -136,8 +228,9 @@ WindowCtx InitWindow(const GameSettings *settings) {
     SDL_FATAL(SDL_GL_MakeCurrent(buffer.window, buffer.glCtx), "Failed to show window")
     // SDL_FATAL(SDL_GL_SetSwapInterval(1), "Failed to enable vsync");
 
-    SDL_Surface *cursor = IMG_Load("data\\pointer.png");
+    SDL_Surface *cursor = LoadSurface("data\\pointer.png");
     SDL_FATAL(SDL_SetCursor(SDL_CreateColorCursor(cursor, 0, 0)), "Failed to set cursor");
+    SDL_DestroySurface(cursor);
 
     if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) LOG_FATAL("Glad failed to load GL")
 
@@ -176,6 +269,7 @@ TimingCtx InitTiming(f32 refreshRate) {
 }
 
 void UpdateTiming(TimingCtx *ctx) {
+    ctx->updates++;
     ctx->time  = SDL_GetTicks();
     ctx->delta = GetSecondsElapsed(ctx->perfFreq, ctx->last, SDL_GetPerformanceCounter());
 
@@ -190,11 +284,18 @@ void UpdateTiming(TimingCtx *ctx) {
     f32 msBehind   = (ctx->delta - ctx->targetSpf) * 1000.0f;
     f64 fps        = (f64)(ctx->perfFreq) / (f64)(SDL_GetPerformanceCounter() - ctx->last);
     // LOG_INFO("FPS: %.2f MsPF: %.2f Ms behind: %.4f", fps, msPerFrame, msBehind);
-    cstr fpsTitle = (cstr)malloc(20);
-    sprintf(fpsTitle, "FPS: %.2f", fps);
-    SDL_SetWindowTitle(Window()->window, fpsTitle);
-    free(fpsTitle);
+    cstr fpsTitle = Window()->window ? FrameAlloc(20) : 0;
+    if (fpsTitle) {
+        SDL_snprintf(fpsTitle, 20, "FPS: %.2f", fps);
+        SDL_SetWindowTitle(Window()->window, fpsTitle);
+    }
 
     ctx->last = ctx->now;
     ctx->now  = SDL_GetPerformanceCounter();
+
+    // Simulated time, whatever the wall clock did
+    if (ctx->fixedDelta > 0) {
+        ctx->delta = ctx->fixedDelta;
+        ctx->time  = (u64)(ctx->updates * ctx->fixedDelta * 1000);
+    }
 }
@@ -7,6 +7,15 @@ typedef struct {
     v2i  resolution;
     bool disableMouse;
     bool fullscreen;
+    bool offlineAudio;      // Renders 1/OFFLINE_UPDATE_RATE s per update into a sink, no device
+    u32  audioVoices;       // At least 64
+    bool headless;          // No window or GPU, implies offlineAudio. The game must not draw.
+    u32  headlessUpdates;   // A headless run stops after this many, 0 leaves it to the game
+    u64  assetBudget;
+    f32  renderScale;       // Of the scene, 1 when 0. 0.5 renders it at half resolution.
+    bool dynamicResolution; // Lowers the scene's scale when the GPU misses the frame budget
+    bool bloom;
+    bool lighting;          // 2D lights and shadows, multiplied into the scene before post
 } GameSettings;
 GameSettings *Settings();
 
@@ -25,10 +34,16 @@ intern void      UpdateWindow(WindowCtx *ctx);
 typedef struct GraphicsCtx GraphicsCtx;
 GraphicsCtx               *Graphics();
 
+// Offline and headless runs advance by a fixed step so the same input renders the same output
+#define OFFLINE_UPDATE_RATE 60
+
 typedef struct {
     f32 delta, targetSpf;
+    f32 fixedDelta; // When set, every update advances by it instead of the measured time
     u64 time, now, last, perfFreq;
+    u64 updates;
 } TimingCtx;
+TimingCtx       *Timing();
 intern TimingCtx InitTiming(f32 refreshRate);
 intern void      UpdateTiming(TimingCtx *ctx);
 inline f32       GetSecondsElapsed(u64 perfCountFreq, u64 start, u64 end) {
@@ -54,8 +69,24 @@ export void  EngineInit();
 export void  EngineUpdate();
 export void  EngineShutdown();
 export void *EngineGetMemory();
+export u64   EngineMemorySize(); // For main_debug, which allocates the block without the headers
 export bool  EngineIsRunning();
 
+// The block main allocates for the engine, holding EngineCtx, then the game's GameState, then
+// Memory, then the frame arenas. The engine can't see GameState's size, so games check that
+// it fits in GAME_STATE_SIZE.
+#define ENGINE_MEMORY_SIZE (128 * 1000000)
+#define GAME_STATE_SIZE (1 * 1000000)
+#define FRAME_ARENA_SIZE (8 * 1000000)
+
 Arena *Memory();
 f32    Delta();
 u64    Time();
+
+// Per frame temporaries. The two frame arenas take turns and each is emptied at the start of
+// the frame it's used for, so what was allocated last frame stays valid through this one.
+// Scratch marks give memory back earlier, for temporaries that don't outlive a function.
+Arena    *FrameArena();
+void     *FrameAlloc(u64 size);
+ArenaMark ScratchBegin();
+void      ScratchEnd(ArenaMark mark);
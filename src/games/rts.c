@@ -20,22 +20,24 @@ struct MoveList {
 typedef struct MoveList MoveList;
 
 typedef struct {
-    u32      count;
-    Texture *tex;
-    f32     *speed;
+    u32   count;
+    Clip *idle;
+    v2i  *size;
+    f32  *speed;
 } UnitTypes;
 
 typedef struct {
-    MemRegion  buffer;
-    u32        count, max;
+    MemRegion      buffer;
+    u32            count, max;
     ComponentTable components;
+    Animators      anims;
 } Entities;
 
 typedef struct {
-    Texture selector;
-    bool    selecting;
-    Rect    selBox;
-    b64     selMap;
+    Sprite selector;
+    bool   selecting;
+    Rect   selBox;
+    b64    selMap;
 } SelectionCtx;
 
 typedef struct {
@@ -47,6 +49,7 @@ typedef struct {
     UnitTypes    unitTypes;
 } GameState;
 GameState *S;
+_Static_assert(sizeof(GameState) <= GAME_STATE_SIZE, "GameState is too big");
 
 extern void Setup() {
     E->Settings = (GameSettings){
@@ -55,26 +58,30 @@ extern void Setup() {
         .resolution = (v2i){1920, 1080},
         .scale      = 1,
     };
-    S = (GameState *)((u8 *)EngineGetMemory() + sizeof(EngineCtx));
 }
 
 extern void Init() {
-    S->unitTypes = (UnitTypes){
-        .count = 8,
-        .tex   = ALLOC(sizeof(Texture) + S->unitTypes.count),
-        .speed = ALLOC(sizeof(f32) + S->unitTypes.count),
+    u32 typeCount = 8;
+    S->unitTypes  = (UnitTypes){
+        .count = typeCount,
+        .idle  = ALLOC(sizeof(Clip) * typeCount),
+        .size  = ALLOC(sizeof(v2i) * typeCount),
+        .speed = ALLOC(sizeof(f32) * typeCount),
     };
-    S->unitTypes.tex[0]   = NewTexture("data\\ship.png");
+    Sprite ship           = NewSprite("data\\ship.png");
+    S->unitTypes.size[0]  = AtlasGet(Graphics()->atlas, ship)->size;
+    S->unitTypes.idle[0]  = NewClip(ship, S->unitTypes.size[0], 0, 1, 1, ANIM_LOOP);
     S->unitTypes.speed[0] = 100;
     S->sounds[0]          = NewSound("data\\gun.wav", ONESHOT);
 
-    S->selCtx.selector = NewTexture("data\\selector_square_32x32.png");
+    S->selCtx.selector = NewSprite("data\\selector_square_32x32.png");
     S->cam             = (Camera){(v2){0}, 1.0f, 200};
 
     S->units = (Entities){.buffer     = NewMemRegion(64 * 10000),
                           .components = NewComponentTable(64, 64),
                           .count      = 64,
                           .max        = 64};
+    S->units.anims = NewAnimators(S->units.count, S->unitTypes.idle[0]);
 
     ComponentTable *comps     = &S->units.components;
     v2         *positions = (v2 *)CompInsert(comps, "pos", ALLOC(S->units.max * sizeof(v2)));
@@ -88,10 +95,7 @@ extern void Init() {
         positions[i] = (v2){Rand() * 640, Rand() * 360};
         targets[i]   = (MoveList){positions[i], 0};
         types[i]     = 0;
-        colliders[i] = (v2){
-            (S->unitTypes.tex[types[i]].size).x,
-            (S->unitTypes.tex[types[i]].size).y,
-        };
+        colliders[i] = (v2){S->unitTypes.size[types[i]].w, S->unitTypes.size[types[i]].h};
     }
 }
 
@@ -119,7 +123,7 @@ void ProcessMouseSelection(SelectionCtx *ctx, const Entities *units, const UnitT
             ctx->selMap = 0;
         }
         for (u64 i = 0; i < units->components.entLen; i++) {
-            v2i size = types->tex[uTypes[i]].size;
+            v2i size = types->size[uTypes[i]];
             if (V2InRect(MouseInWorld(S->cam),
                          (Rect){(v2){pos[i].x - size.x / 2, pos[i].y - size.y / 2},
                                 (v2){size.x, size.y}})) {
@@ -238,13 +242,13 @@ void DrawUnits(const UnitTypes *types, const Entities *units, const SelectionCtx
     const v2  *pos    = CompGet(&units->components, "pos");
     const u32 *uTypes = CompGet(&units->components, "types");
 
-    for (u64 i = 0; i < units->components.entLen; i++) {
-        Texture tex = types->tex[uTypes[i]];
+    // Every frame and the selector are in the atlas, so this is a single instanced draw
+    for (u32 i = 0; i < units->components.entLen; i++) {
+        v2i size    = types->size[uTypes[i]];
+        v2  topLeft = v2Sub(pos[i], (v2){size.w / 2.0f, size.h / 2.0f});
 
-        // TextureDraw(tex, v2Sub(pos[i], (v2){tex.size.x / 2, tex.size.y / 2}), 1);
-        // if (ctx->selMap & (1ull << i)) {
-        //     TextureDraw(ctx->selector, v2Sub(pos[i], (v2){tex.size.x / 2, tex.size.y / 2}), 1);
-        // }
+        DrawAnimator(&units->anims, i, topLeft, 0, WHITE);
+        if (ctx->selMap & (1ull << i)) DrawSprite(ctx->selector, topLeft, 0);
     }
 }
 
@@ -252,8 +256,10 @@ extern void Update() {
     ProcessMouseSelection(&S->selCtx, &S->units, &S->unitTypes);
     ProcessMovementToTarget(&S->selCtx, &S->units);
     CalculateMovementToTargetWithCollision(&S->units, &S->unitTypes);
+    UpdateAnimators(&S->units.anims, Delta());
 
     ProcessWASDCamera(&S->cam);
+    AudioSetListener(S->cam);
 }
 
 extern void Draw() {
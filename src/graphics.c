@@ -1,27 +1,331 @@
 #include "graphics.h"
+#include "animation.h"
+#include "debugdraw.h"
+#include "lights.h"
+#include "pack.h"
+#include "particles.h"
+#include "rendergraph.h"
+#include "tessellate.h"
+#include "text.h"
+
+intern void CullSetCamera(Camera cam) {
+    v2 res               = GetResolution();
+    v2 half              = v2Scale(res, 0.5f / CameraScale(cam));
+    Graphics()->cullView = (CullView){
+        .center = v2Add(cam.pos, v2Scale(res, 0.5f)),
+        .half   = half,
+        .cos    = cosf(cam.rotation),
+        .sin    = sinf(cam.rotation),
+    };
+}
+
+intern void CameraSet(Camera cam) {
+    Graphics()->cam      = cam;
+    Graphics()->viewProj = CameraViewProj(cam);
+    CullSetCamera(cam);
+}
 
 void CameraBegin(Camera cam) {
-    Graphics()->cam = cam;
+    FlushBatches();
+    CameraSet(cam);
+    Graphics()->sceneCam = cam;
 }
 
 void CameraEnd() {
-    Graphics()->cam = (Camera){0};
+    FlushBatches();
+    CameraSet((Camera){0});
+}
+
+f32 CameraScale(Camera cam) {
+    return powf(2.0f, cam.zoom);
+}
+
+// Rotates by -rotation around the view's center and scales, then maps the screen to [-1, 1]
+// with y going up
+m3 CameraViewProj(Camera cam) {
+    v2  res    = GetResolution();
+    v2  center = v2Add(cam.pos, v2Scale(res, 0.5f));
+    f32 c      = cosf(cam.rotation);
+    f32 s      = sinf(cam.rotation);
+    f32 sx     = 2.0f * CameraScale(cam) / res.w;
+    f32 sy     = 2.0f * CameraScale(cam) / res.h;
+    v2  offset = {-sx * (c * center.x + s * center.y), -sy * (s * center.x - c * center.y)};
+
+    return (m3){{sx * c, sy * s, 0, sx * s, -sy * c, 0, offset.x, offset.y, 1}};
+}
+
+v2 WorldToScreen(Camera cam, v2 world) {
+    v2 res  = GetResolution();
+    v2 clip = m3MulV2(CameraViewProj(cam), world);
+    return (v2){(clip.x + 1) * 0.5f * res.w, (1 - clip.y) * 0.5f * res.h};
+}
+
+v2 ScreenToWorld(Camera cam, v2 screen) {
+    v2 res  = GetResolution();
+    v2 clip = {screen.x / res.w * 2 - 1, 1 - screen.y / res.h * 2};
+    return m3MulV2(m3Inverse(CameraViewProj(cam)), clip);
+}
+
+// World space bounds of what the camera sees, zooming and rotating around the screen center
+Rect CameraViewRect(Camera cam) {
+    v2  res    = GetResolution();
+    v2  half   = v2Scale(res, 0.5f / CameraScale(cam));
+    v2  center = v2Add(cam.pos, v2Scale(res, 0.5f));
+    f32 c      = f32Abs(cosf(cam.rotation));
+    f32 s      = f32Abs(sinf(cam.rotation));
+    v2  extent = {c * half.w + s * half.h, s * half.w + c * half.h};
+
+    return (Rect){center.x - extent.w, center.y - extent.h, extent.w * 2, extent.h * 2};
+}
+
+bool Culled(Rect rect, f32 rotation) {
+    GraphicsCtx *graphics = Graphics();
+    CullView     view     = graphics->cullView;
+
+    // Half extents of the rect once rotated into camera space
+    v2  half  = v2Scale(rect.size, 0.5f);
+    f32 angle = rotation - graphics->cam.rotation;
+    if (angle != 0) {
+        f32 c = f32Abs(cosf(angle));
+        f32 s = f32Abs(sinf(angle));
+        half  = (v2){c * half.w + s * half.h, s * half.w + c * half.h};
+    }
+
+    v2 d     = v2Sub(rect.pos, view.center);
+    v2 local = {view.cos * d.x + view.sin * d.y, view.cos * d.y - view.sin * d.x};
+    if (f32Abs(local.x) > view.half.w + half.w || f32Abs(local.y) > view.half.h + half.h) {
+        graphics->cull.culled++;
+        return true;
+    }
+
+    graphics->cull.drawn++;
+    return false;
+}
+
+CullStats GetCullStats() {
+    return Graphics()->lastCull;
 }
 
 v2 GetResolution() {
-    v2i result = {0};
-    SDL_GetWindowSize(Window()->window, &result.x, &result.y);
+    v2i result = Settings()->resolution;
+    if (Window()->window) SDL_GetWindowSize(Window()->window, &result.x, &result.y);
     return (v2){(f32)result.x, (f32)result.y};
 }
 
 v2 MouseInWorld(Camera cam) {
-    v2 mouse = Mouse();
-    return (v2){mouse.x + cam.pos.x, mouse.y + cam.pos.y};
+    return ScreenToWorld(cam, Mouse());
+}
+
+intern u64 ShaderHash(u64 hash, const void *data, u64 len) {
+    for (u64 i = 0; i < len; i++) hash = (hash ^ ((const u8 *)data)[i]) * 1099511628211ull;
+    return hash;
+}
+
+// Driver updates can change or invalidate the binary format, so they're part of the key
+intern u64 ShaderCacheKey(string vertSrc, string fragSrc) {
+    u64  hash = 14695981039346656037ull;
+    cstr driver[] = {(cstr)glGetString(GL_VENDOR), (cstr)glGetString(GL_RENDERER),
+                     (cstr)glGetString(GL_VERSION)};
+    for (u32 i = 0; i < SDL_arraysize(driver); i++)
+        if (driver[i]) hash = ShaderHash(hash, driver[i], SDL_strlen(driver[i]) + 1);
+    hash = ShaderHash(hash, vertSrc.data, vertSrc.len + 1);
+    return ShaderHash(hash, fragSrc.data, fragSrc.len);
+}
+
+intern u32 ShaderLoadCache(cstr cachePath, u64 hash) {
+    u64                len    = 0;
+    u8                *data   = SDL_LoadFile(cachePath, &len);
+    ShaderCacheHeader *header = (ShaderCacheHeader *)data;
+    if (!data || len < sizeof(ShaderCacheHeader) || header->magic != SHADER_CACHE_MAGIC ||
+        header->version != SHADER_CACHE_VERSION || header->hash != hash ||
+        len != sizeof(ShaderCacheHeader) + header->len) {
+        SDL_free(data);
+        return 0;
+    }
+
+    u32 program = glCreateProgram();
+    glProgramBinary(program, header->format, data + sizeof(ShaderCacheHeader), header->len);
+    SDL_free(data);
+
+    // The driver is free to reject binaries it made itself, in which case we just recompile
+    i32 ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+intern void ShaderSaveCache(u32 program, cstr cachePath, u64 hash) {
+    i32 len = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &len);
+    if (len <= 0) return;
+
+    u8                *data    = SDL_malloc(sizeof(ShaderCacheHeader) + len);
+    ShaderCacheHeader *header  = (ShaderCacheHeader *)data;
+    u32                format  = 0;
+    i32                written = 0;
+    glGetProgramBinary(program, len, &written, &format, data + sizeof(ShaderCacheHeader));
+
+    *header = (ShaderCacheHeader){
+        .magic   = SHADER_CACHE_MAGIC,
+        .version = SHADER_CACHE_VERSION,
+        .hash    = hash,
+        .format  = format,
+        .len     = (u32)written,
+    };
+    SDL_CreateDirectory(SHADER_CACHE_DIR);
+    if (!SDL_SaveFile(cachePath, data, sizeof(ShaderCacheHeader) + written))
+        LOG_WARNING("Couldn't write shader cache %s: %s", cachePath, SDL_GetError());
+    SDL_free(data);
+}
+
+intern u32 ShaderCompileStage(u32 type, string src, cstr path) {
+    u32 shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src.data, 0);
+    glCompileShader(shader);
+
+    i32 ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        ShaderPrintError(shader, path);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+intern u32 ShaderCompile(string vertSrc, string fragSrc, cstr vertFile, cstr fragFile) {
+    u32 vertShader = ShaderCompileStage(GL_VERTEX_SHADER, vertSrc, vertFile);
+    u32 fragShader = vertShader ? ShaderCompileStage(GL_FRAGMENT_SHADER, fragSrc, fragFile) : 0;
+    if (!fragShader) {
+        glDeleteShader(vertShader);
+        return 0;
+    }
+
+    u32 program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vertShader);
+    glAttachShader(program, fragShader);
+    glLinkProgram(program);
+    glDeleteShader(vertShader);
+    glDeleteShader(fragShader);
+
+    i32 ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        ShaderPrintProgramError(program);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+typedef struct {
+    char *data;
+    u64   len, cap;
+    u64   files[SHADER_MAX_FILES];
+    u32   fileCount;
+} ShaderSource;
+
+intern void ShaderAppend(ShaderSource *src, const char *text, u64 len) {
+    if (src->len + len + 1 > src->cap) {
+        src->cap  = MAX(src->cap * 2, src->len + len + 1024);
+        src->data = SDL_realloc(src->data, src->cap);
+    }
+    SDL_memcpy(src->data + src->len, text, len);
+    src->len += len;
+    src->data[src->len] = 0;
+}
+
+intern void ShaderAppendf(ShaderSource *src, cstr fmt, ...) {
+    char    line[256];
+    va_list args;
+    va_start(args, fmt);
+    i32 len = SDL_vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    ShaderAppend(src, line, (u64)MIN(len, (i32)sizeof(line) - 1));
+}
+
+// Pastes path into src, expanding includes. #line directives keep compiler errors pointing at
+// the right line, with the file's index in src->files as the source string number.
+intern bool ShaderExpand(ShaderSource *src, cstr path, cstr defines, u32 depth) {
+    if (depth > SHADER_MAX_INCLUDE_DEPTH) {
+        LOG_ERROR("Includes nested too deep at %s", path);
+        return false;
+    }
+
+    u64 hash = PackHash(path);
+    for (u32 i = 0; i < src->fileCount; i++)
+        if (src->files[i] == hash) return true;
+    if (src->fileCount == SHADER_MAX_FILES) {
+        LOG_ERROR("Too many includes, can't include %s", path);
+        return false;
+    }
+    u32 fileIndex                = src->fileCount;
+    src->files[src->fileCount++] = hash;
+
+    // Reloads only happen once the watcher has seen the file settle, so a missing file here
+    // is a real error rather than an editor halfway through saving
+    string file = LoadAsset(path);
+    if (!file.data) {
+        LOG_ERROR("Couldn't read shader %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    bool ok   = true;
+    u32  line = 1;
+    for (cstr at = file.data, end = file.data + file.len; at < end && ok; line++) {
+        cstr eol = memchr(at, '\n', end - at);
+        eol      = eol ? eol + 1 : end;
+
+        cstr directive = at;
+        while (directive < eol && (*directive == ' ' || *directive == '\t')) directive++;
+
+        if (depth == 0 && !SDL_strncmp(directive, "#version", 8)) {
+            ShaderAppend(src, at, eol - at);
+            if (defines) ShaderAppend(src, defines, SDL_strlen(defines));
+            ShaderAppendf(src, "#line %u %u\n", line + 1, fileIndex);
+        } else if (!SDL_strncmp(directive, "#include", 8)) {
+            cstr open  = memchr(directive, '"', eol - directive);
+            cstr close = open ? memchr(open + 1, '"', eol - open - 1) : 0;
+            if (!close) {
+                LOG_ERROR("%s:%u: malformed #include", path, line);
+                ok = false;
+                break;
+            }
+
+            // Included paths are relative to the including file
+            cstr slash = path;
+            for (cstr c = path; *c; c++)
+                if (*c == '/' || *c == '\\') slash = c + 1;
+
+            char includePath[128];
+            SDL_snprintf(includePath, sizeof(includePath), "%.*s%.*s", (i32)(slash - path), path,
+                         (i32)(close - open - 1), open + 1);
+            ShaderAppendf(src, "#line 1 %u\n", src->fileCount);
+            ok = ShaderExpand(src, includePath, defines, depth + 1);
+            ShaderAppendf(src, "#line %u %u\n", line + 1, fileIndex);
+        } else {
+            ShaderAppend(src, at, eol - at);
+        }
+
+        at = eol;
+    }
+    if (src->len && src->data[src->len - 1] != '\n') ShaderAppend(src, "\n", 1);
+
+    FreeAsset(file);
+    return ok;
 }
 
 Shader ShaderFromPath(cstr vertFile, cstr fragFile) {
+    return ShaderFromPathDefines(vertFile, fragFile, 0);
+}
+
+// defines is pasted verbatim after #version, so it's a list of "#define NAME value\n" lines
+Shader ShaderFromPathDefines(cstr vertFile, cstr fragFile, cstr defines) {
     Shader result = {0};
-    i32    ok     = 0;
 
     if (!vertFile) vertFile = "shaders\\default.vert";
     if (!fragFile) fragFile = "shaders\\default.frag";
@@ -29,54 +333,113 @@ Shader ShaderFromPath(cstr vertFile, cstr fragFile) {
 #ifdef DEBUG
     result.vertPath = vertFile;
     result.fragPath = fragFile;
-
-    result.vertWrite = GetLastWriteTime(result.vertPath);
-    result.fragWrite = GetLastWriteTime(result.fragPath);
+    result.defines  = defines;
 #endif
 
-    string vertSrc = ReadEntireFile(vertFile);
-    string fragSrc = ReadEntireFile(fragFile);
+    ShaderSource vert = {0}, frag = {0};
+    bool         ok   = ShaderExpand(&vert, vertFile, defines, 0);
+    ok                = ok && ShaderExpand(&frag, fragFile, defines, 0);
 
-    // TODO(viole): Esto es sólo para evitar errores al hacer reload.
-    // Cambiar por algo mejor.
-    while (!vertSrc.data) vertSrc = ReadEntireFile(vertFile);
-    while (!fragSrc.data) fragSrc = ReadEntireFile(fragFile);
+#ifdef DEBUG
+    for (u32 i = 0; i < vert.fileCount; i++) result.files[result.fileCount++] = vert.files[i];
+    for (u32 i = 0; i < frag.fileCount && result.fileCount < SHADER_MAX_FILES; i++)
+        result.files[result.fileCount++] = frag.files[i];
+#endif
 
-    u32 vertShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShader, 1, &vertSrc.data, 0);
-    glCompileShader(vertShader);
+    if (ok) {
+        string vertSrc = {vert.data, vert.len};
+        string fragSrc = {frag.data, frag.len};
 
-    glGetShaderiv(vertShader, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        ShaderPrintError(vertShader, vertFile);
-        return (Shader){0};
-    }
+        u64  hash = ShaderCacheKey(vertSrc, fragSrc);
+        char cachePath[64];
+        SDL_snprintf(cachePath, sizeof(cachePath), SHADER_CACHE_DIR "/%016llx.bin",
+                     (unsigned long long)hash);
 
-    u32 fragShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShader, 1, &fragSrc.data, 0);
-    glCompileShader(fragShader);
-    glGetShaderiv(fragShader, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        ShaderPrintError(fragShader, fragFile);
-        return (Shader){0};
+        result.id = ShaderLoadCache(cachePath, hash);
+        if (!result.id) {
+            result.id = ShaderCompile(vertSrc, fragSrc, vertFile, fragFile);
+            if (result.id) ShaderSaveCache(result.id, cachePath, hash);
+        }
     }
 
-    result.id = glCreateProgram();
-    glAttachShader(result.id, vertShader);
-    glAttachShader(result.id, fragShader);
-    glLinkProgram(result.id);
-    glGetProgramiv(result.id, GL_LINK_STATUS, &ok);
+    SDL_free(vert.data);
+    SDL_free(frag.data);
+    return result;
+}
+
+intern u32 ShaderCompileCompute(string src, cstr file) {
+    u32 stage = ShaderCompileStage(GL_COMPUTE_SHADER, src, file);
+    if (!stage) return 0;
+
+    u32 program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, stage);
+    glLinkProgram(program);
+    glDeleteShader(stage);
+
+    i32 ok = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
     if (!ok) {
-        ShaderPrintProgramError(result.id);
-        exit(-1);
+        ShaderPrintProgramError(program);
+        glDeleteProgram(program);
+        return 0;
     }
+    return program;
+}
 
-    glDeleteShader(vertShader);
-    glDeleteShader(fragShader);
+// Goes through the same preprocessor and binary cache as vertex/fragment programs
+Shader ComputeShaderFromPath(cstr compFile, cstr defines) {
+    Shader result = {0};
+
+#ifdef DEBUG
+    result.compPath = compFile;
+    result.defines  = defines;
+#endif
 
+    ShaderSource comp = {0};
+    bool         ok   = ShaderExpand(&comp, compFile, defines, 0);
+
+#ifdef DEBUG
+    for (u32 i = 0; i < comp.fileCount; i++) result.files[result.fileCount++] = comp.files[i];
+#endif
+
+    if (ok) {
+        string src = {comp.data, comp.len};
+
+        u64  hash = ShaderCacheKey(src, (string){"", 0});
+        char cachePath[64];
+        SDL_snprintf(cachePath, sizeof(cachePath), SHADER_CACHE_DIR "/%016llx.bin",
+                     (unsigned long long)hash);
+
+        result.id = ShaderLoadCache(cachePath, hash);
+        if (!result.id) {
+            result.id = ShaderCompileCompute(src, compFile);
+            if (result.id) ShaderSaveCache(result.id, cachePath, hash);
+        }
+    }
+
+    SDL_free(comp.data);
     return result;
 }
 
+ShaderVariants NewShaderVariants(cstr vertPath, cstr fragPath, cstr key) {
+    return (ShaderVariants){.vertPath = vertPath, .fragPath = fragPath, .key = key};
+}
+
+Shader ShaderVariant(ShaderVariants *set, u32 variant) {
+    if (variant >= SHADER_MAX_VARIANTS) return (Shader){0};
+
+    // Failed variants are marked as built too, so a broken shader isn't recompiled every draw
+    if (!(set->built & (1u << variant))) {
+        set->built |= 1u << variant;
+        SDL_snprintf(set->defines[variant], sizeof(set->defines[variant]), "#define %s %u\n",
+                     set->key, variant);
+        set->variants[variant] =
+            ShaderFromPathDefines(set->vertPath, set->fragPath, set->defines[variant]);
+    }
+    return set->variants[variant];
+}
+
 void ShaderUse(Shader shader) {
     glUseProgram(shader.id);
     LOG_GL_ERROR("Couldn't use shader program");
@@ -84,27 +447,34 @@ void ShaderUse(Shader shader) {
     Graphics()->activeShader = shader.id;
     SetUniform1i("t", Time());
     SetUniform2f("res", GetResolution());
-    SetUniform2f("camPos", Graphics()->cam.pos);
-    SetUniform1f("camZoom", Graphics()->cam.zoom);
-    SetUniform1f("camRotation", Graphics()->cam.rotation);
+    SetUniformM3("viewProj", Graphics()->viewProj);
 }
 
+// The old program is kept if the new source doesn't compile
 void ShaderReload(Shader *shader) {
 #ifdef DEBUG
-    u64 vertTime = GetLastWriteTime(shader->vertPath);
-    u64 fragTime = GetLastWriteTime(shader->fragPath);
-    if (vertTime <= shader->vertWrite && fragTime <= shader->fragWrite) return;
-
-    Shader newShader = ShaderFromPath(shader->vertPath, shader->fragPath);
-    if (newShader.id != 0) {
-        glDeleteProgram(shader->id);
-        *shader = newShader;
-    } else {
-        shader->vertWrite = vertTime;
-        shader->fragWrite = fragTime;
-    }
+    Shader newShader =
+        shader->compPath
+            ? ComputeShaderFromPath(shader->compPath, shader->defines)
+            : ShaderFromPathDefines(shader->vertPath, shader->fragPath, shader->defines);
+    if (newShader.id == 0) return;
+
+    glDeleteProgram(shader->id);
+    *shader = newShader;
+#endif
+}
+
+bool ShaderUsesFile(const Shader *shader, cstr path) {
+#ifdef DEBUG
+    if (!shader->id) return false;
+
+    u64 hash = PackHash(path);
+    for (u32 i = 0; i < shader->fileCount; i++)
+        if (shader->files[i] == hash) return true;
+    return false;
+#else
+    return false;
 #endif
-    return;
 }
 
 void SetUniform1i(cstr name, i32 value) {
@@ -123,6 +493,16 @@ void SetUniform1fv(cstr name, f32 *value, u64 count) {
     glUniform1fv(glGetUniformLocation(Graphics()->activeShader, name), (i32)count, value);
 }
 
+void SetUniform1uiv(cstr name, u32 *value, u64 count) {
+    if (count == 0) return;
+    glUniform1uiv(glGetUniformLocation(Graphics()->activeShader, name), (i32)count, value);
+}
+
+void SetUniform4uiv(cstr name, u32 *value, u64 count) {
+    if (count == 0) return;
+    glUniform4uiv(glGetUniformLocation(Graphics()->activeShader, name), (i32)count, value);
+}
+
 void SetUniform2f(cstr name, v2 value) {
     glUniform2f(glGetUniformLocation(Graphics()->activeShader, name), value.x, value.y);
 }
@@ -140,106 +520,42 @@ void SetUniform1b(cstr name, bool value) {
     SetUniform1i(name, (value ? 1 : 0));
 }
 
+void SetUniformM3(cstr name, m3 value) {
+    glUniformMatrix3fv(glGetUniformLocation(Graphics()->activeShader, name), 1, GL_FALSE, value.m);
+}
+
 void ShaderPrintError(u32 shader, char *shaderPath) {
     i32 logLength = 0;
     glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
 
-    char *infoLog = malloc(logLength);
-    glGetShaderInfoLog(shader, logLength, 0, infoLog);
-
-    LOG_ERROR("%s - %s", shaderPath, infoLog);
-
-    free(infoLog);
+    ArenaMark scratch = ScratchBegin();
+    char     *infoLog = FrameAlloc(logLength);
+    if (infoLog) {
+        glGetShaderInfoLog(shader, logLength, 0, infoLog);
+        LOG_ERROR("%s - %s", shaderPath, infoLog);
+    }
+    ScratchEnd(scratch);
 }
 
 void ShaderPrintProgramError(u32 program) {
     i32 logLength = 0;
-    glGetShaderiv(program, GL_INFO_LOG_LENGTH, &logLength);
-
-    char *infoLog = malloc(logLength);
-    glGetProgramInfoLog(program, logLength, 0, infoLog);
-
-    LOG_ERROR(infoLog);
-
-    free(infoLog);
-}
-
-Framebuffer NewFramebuffer(cstr fragPath) {
-    Framebuffer result = {0};
-
-    persist f32 verts[] = {-1, 1, 0, 1, -1, -1, 0, 0, 1, -1, 1, 0,
-                           -1, 1, 0, 1, 1,  -1, 1, 0, 1, 1,  1, 1};
-    u32         quadVAO, quadVBO;
-    glGenVertexArrays(1, &quadVAO);
-    glGenBuffers(1, &quadVBO);
-    glBindVertexArray(quadVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(v4), 0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(v4), (void *)(sizeof(v2)));
-    glEnableVertexAttribArray(1);
-    result.vao = quadVAO;
-
-    glGenFramebuffers(1, &result.fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, result.fbo);
-
-    glGenTextures(1, &result.tex);
-    glBindTexture(GL_TEXTURE_2D, result.tex);
-    v2 res = GetResolution();
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (i32)res.w, (i32)res.h, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, result.tex, 0);
-
-    glGenRenderbuffers(1, &result.rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, result.rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (i32)res.w, (i32)res.h);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
-                              result.rbo);
-
-    while (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) continue;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    Shader shader = ShaderFromPath("shaders\\post.vert", fragPath);
-    result.shader = shader;
-
-    return result;
-}
-
-void Framebufferuse(Framebuffer shader) {
-    glBindFramebuffer(GL_FRAMEBUFFER, shader.fbo);
-}
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
 
-void FramebufferDraw(Framebuffer shader) {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    ClearScreen((v4){0});
-
-    ShaderUse(shader.shader);
-
-    glBindVertexArray(shader.vao);
-    glBindTexture(GL_TEXTURE_2D, shader.tex);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-}
-
-void FramebufferResize(Framebuffer shader) {
-    v2 res = GetResolution();
-    glBindTexture(GL_TEXTURE_2D, shader.tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (i32)res.w, (i32)res.h, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, shader.tex);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (i32)res.w, (i32)res.h);
+    ArenaMark scratch = ScratchBegin();
+    char     *infoLog = FrameAlloc(logLength);
+    if (infoLog) {
+        glGetProgramInfoLog(program, logLength, 0, infoLog);
+        LOG_ERROR("%s", infoLog);
+    }
+    ScratchEnd(scratch);
 }
 
 Texture NewTexture(cstr path) {
-    SDL_Surface *img = IMG_Load(path);
-    if (!img) {
-        LOG_ERROR("Couldn't load texture: %s", SDL_GetError());
-        return (Texture){0};
-    }
+    SDL_Surface *img = LoadSurface(path);
+    if (!img) return (Texture){0};
 
     Texture result = TextureFromMemory((void *)img->pixels, (v2i){img->w, img->h});
-    SDL_free(img);
+    SDL_DestroySurface(img);
     return result;
 }
 
@@ -281,6 +597,11 @@ void DrawInstances(u32 count) {
     glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, count);
 }
 
+// Per-instance attributes start at element first of their buffer
+void DrawInstancesFrom(u32 first, u32 count) {
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, count, first);
+}
+
 void DrawElement() {
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 }
@@ -294,82 +615,69 @@ bool CollisionRectRect(Rect a, Rect b) {
     return a.x <= b.x + b.w && a.x + a.w >= b.x && a.y <= b.y + b.h && a.y + a.h >= b.y;
 }
 
-typedef enum { SHAPE_RECT, SHAPE_LINE, SHAPE_CIRCLE, SHAPE_HEXAGON, SHAPE_COUNT } Shapes;
-
-void DrawRectangle(Rect rect, f32 rotation, v4 color, f32 radius) {
-    ShaderUse(Graphics()->builtinShaders[SHADER_Rect]);
-    SetUniform2f("pos", v2Add(rect.pos, v2Scale(rect.size, 0.5)));
-    SetUniform2f("size", rect.size);
-    SetUniform1f("rotation", rotation);
-    SetUniform1f("radius", radius);
-    SetUniform1f("border", 100);
-
-    SetUniform1i("tex0", 0);
-    SetUniform4f("color", color);
-
-    glBindVertexArray(Graphics()->builtinVAOs[VAO_SQUARE].id);
-    LOG_GL_ERROR("VAO binding failed");
-    {
-        DrawElement();
-        LOG_GL_ERROR("Drawing failed");
-    }
-    glBindVertexArray(0);
+// Rectangles and lines are shapes too, so mixing them with other shapes keeps one draw
+void DrawRectangle(Rect rect, f32 rotation, v4 color, f32 rounding) {
+    DrawShape(SHAPE_RECT, rect, rotation, color, rounding, 0);
 }
 
 void DrawTexture(Texture tex, v2 pos, f32 rotation) {
-    TextureUse(tex, 0);
-    DrawRectangle((Rect){pos.x, pos.y, tex.size.w, tex.size.h}, rotation, COLOR_NULL, 0);
-    TextureEnd(0);
+    BatchPush(tex.id, (Rect){pos.x, pos.y, tex.size.w, tex.size.h}, (Rect){0, 0, 1, 1}, WHITE,
+              rotation);
 }
 
+// One pixel wide whatever the zoom
 void DrawLine(v2 from, v2 to, v4 color) {
-    ShaderUse(Graphics()->builtinShaders[SHADER_Default]);
-    f32 swapY = from.y;
-    from.y    = to.y;
-    to.y      = swapY;
-    SetUniform2f("pos", from);
-    SetUniform2f("size", v2Sub(to, from));
-    SetUniform4f("color", color);
-
-    glBindVertexArray(Graphics()->builtinVAOs[VAO_LINE].id);
-    LOG_GL_ERROR("VAO binding failed");
-    {
-        glDrawArrays(GL_LINES, 0, 2);
-        LOG_GL_ERROR("Drawing failed");
-    }
-    glBindVertexArray(0);
+    DrawThickLine(from, to, 1.0f / CameraScale(Graphics()->cam), color);
 }
 
-void DrawCircle(v2 center, f32 radius, v4 color, bool line, f32 thickness) {
-    Rect rect = {.x = center.x, .y = center.y, .w = radius * 2, .h = radius * 2};
+void DrawShape(Shapes shape, Rect rect, f32 rotation, v4 color, f32 rounding, f32 thickness) {
+    ShapePush((ShapeInstance){
+        .rect      = {rect.x + rect.w / 2, rect.y + rect.h / 2, rect.w, rect.h},
+        .color     = color,
+        .rotation  = rotation,
+        .rounding  = rounding,
+        .thickness = thickness,
+        .shape     = shape,
+    });
+}
 
-    ShaderUse(Graphics()->builtinShaders[SHADER_Circle]);
-    SetUniform2f("pos", rect.pos);
-    SetUniform2f("size", rect.size);
-    SetUniform1f("rotation", 0);
+void DrawCircle(v2 center, f32 radius, v4 color, bool line, f32 thickness) {
+    ShapePush((ShapeInstance){
+        .rect      = {center.x, center.y, radius * 2, radius * 2},
+        .color     = color,
+        .thickness = line ? thickness : 0,
+        .shape     = SHAPE_CIRCLE,
+    });
+}
 
-    SetUniform1i("shape", SHAPE_CIRCLE);
-    SetUniform1b("line", line);
-    SetUniform1f("thickness", thickness);
-    SetUniform1f("radius", 0);
-    SetUniform4f("color", color);
+void DrawHexagon(v2 center, f32 radius, f32 rotation, v4 color) {
+    ShapePush((ShapeInstance){
+        .rect     = {center.x, center.y, radius * 2, radius * 2},
+        .color    = color,
+        .rotation = rotation,
+        .shape    = SHAPE_HEXAGON,
+    });
+}
 
-    glBindVertexArray(Graphics()->builtinVAOs[VAO_SQUARE].id);
-    LOG_GL_ERROR("VAO binding failed");
-    {
-        DrawElement();
-        LOG_GL_ERROR("Drawing failed");
-    }
-    glBindVertexArray(0);
+// A capsule around the segment, so joined lines don't show gaps at the corners
+void DrawThickLine(v2 from, v2 to, f32 thickness, v4 color) {
+    v2  dir = v2Sub(to, from);
+    f32 len = sqrtf(dir.x * dir.x + dir.y * dir.y);
+    ShapePush((ShapeInstance){
+        .rect     = {(from.x + to.x) / 2, (from.y + to.y) / 2, len + thickness, thickness},
+        .color    = color,
+        .rotation = atan2f(dir.y, dir.x),
+        .shape    = SHAPE_LINE,
+    });
 }
 
+// One pixel wide whatever the zoom, like DrawLine
 void DrawPoly(Poly poly, v4 color) {
-    for (u32 i = 0; i < poly.count - 1; i++) {
-        DrawLine(poly.verts[i], poly.verts[i + 1], color);
-    }
+    LineStyle style = {.thickness = 1.0f / CameraScale(Graphics()->cam)};
+    DrawPolyline(poly, style, color);
 }
 
-VAO LoadSquareMesh() {
+intern void LoadSquareBuffers() {
     persist f32 sqVerts[] = {
         //  x     y     u     v
         -0.5f, -0.5f, 0.0f, 0.0f, // bottom left
@@ -382,70 +690,491 @@ VAO LoadSquareMesh() {
         2, 3, 0  // second triangle
     };
 
-    VAO result = {0};
-
-    glGenVertexArrays(1, &result.id);
     u32 vbo = 0, ebo = 0;
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
 
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(sqVerts), sqVerts, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sqIds), sqIds, GL_STATIC_DRAW);
+
+    // Position attribute (location = 0)
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(f32), (void *)(0));
+
+    // UV attribute (location = 1)
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(f32), (void *)(2 * sizeof(f32)));
+}
+
+VAO LoadSquareMesh() {
+    VAO result = {0};
+
+    glGenVertexArrays(1, &result.id);
     glBindVertexArray(result.id);
+    LoadSquareBuffers();
+    glBindVertexArray(0);
+
+    return result;
+}
+
+StreamBuffer NewStreamBuffer(u32 stride, u32 capacity) {
+    StreamBuffer result = {.stride = stride, .capacity = capacity};
+    u64          size   = (u64)stride * capacity * STREAM_REGIONS;
+    u32          flags  = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &result.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, result.vbo);
+    glBufferStorage(GL_ARRAY_BUFFER, size, 0, flags);
+    result.mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    if (!result.mapped) LOG_ERROR("Couldn't map stream buffer: %d", glGetError());
+
+    return result;
+}
+
+// Returns space for one element, or 0 once the region is full and needs StreamAdvance
+void *StreamPush(StreamBuffer *stream) {
+    if (!stream->mapped || stream->used == stream->capacity) return 0;
+    u64 index = (u64)stream->region * stream->capacity + stream->used++;
+    return stream->mapped + index * stream->stride;
+}
+
+// Index of the current region's first element, for base instance/vertex draws
+u32 StreamBase(const StreamBuffer *stream) {
+    return stream->region * stream->capacity;
+}
+
+void StreamAdvance(StreamBuffer *stream) {
+    if (stream->used == 0) return;
+
+    stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stream->region                 = (stream->region + 1) % STREAM_REGIONS;
+    stream->used                   = 0;
+
+    // Only blocks when the GPU is still reading the region from STREAM_REGIONS advances ago
+    GLsync fence = stream->fences[stream->region];
+    if (!fence) return;
+    while (true) {
+        u32 status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        if (status != GL_TIMEOUT_EXPIRED) {
+            if (status == GL_WAIT_FAILED) LOG_ERROR("Couldn't wait for stream buffer fence");
+            break;
+        }
+    }
+    glDeleteSync(fence);
+    stream->fences[stream->region] = 0;
+}
+
+SpriteBatch NewSpriteBatch() {
+    SpriteBatch result = {0};
+
+    glGenVertexArrays(1, &result.vao);
+    glBindVertexArray(result.vao);
     {
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(sqVerts), sqVerts, GL_STATIC_DRAW);
+        LoadSquareBuffers();
+
+        result.stream = NewStreamBuffer(sizeof(SpriteInstance), BATCH_MAX);
+
+        // Per-instance rect, uv, color and rotation (locations 2-5)
+        u32 stride = sizeof(SpriteInstance);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(SpriteInstance, rect));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(SpriteInstance, uv));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(SpriteInstance, color));
+        glEnableVertexAttribArray(5);
+        glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(SpriteInstance, rotation));
+        for (u32 i = 2; i <= 5; i++) glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sqIds), sqIds, GL_STATIC_DRAW);
+    return result;
+}
 
-        // Position attribute (location = 0)
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(f32), (void *)(0));
+void BatchPush(u32 texture, Rect dst, Rect uv, v4 color, f32 rotation) {
+    BatchPushShader(SHADER_Sprite, texture, dst, uv, color, rotation);
+}
+
+void BatchPushShader(BuiltinShaders shader, u32 texture, Rect dst, Rect uv, v4 color,
+                     f32 rotation) {
+    Rect rect = {dst.x + dst.w / 2, dst.y + dst.h / 2, dst.w, dst.h};
+    if (Culled(rect, rotation)) return;
+
+    SpriteBatch *batch = &Graphics()->batch;
+    if (Graphics()->shapeBatch.count || Graphics()->polyBatch.count ||
+        (batch->count > 0 && (batch->texture != texture || batch->shader != shader)))
+        FlushBatches();
+
+    SpriteInstance *instance = StreamPush(&batch->stream);
+    if (!instance) {
+        FlushBatches();
+        StreamAdvance(&batch->stream);
+        if (!(instance = StreamPush(&batch->stream))) return;
+    }
+
+    batch->texture = texture;
+    batch->shader  = shader;
+    batch->count++;
+    *instance = (SpriteInstance){
+        .rect     = rect,
+        .uv       = uv,
+        .color    = color,
+        .rotation = rotation,
+    };
+}
+
+intern void FlushSprites() {
+    SpriteBatch *batch = &Graphics()->batch;
+    if (batch->count == 0) return;
+
+    u32 count    = batch->count;
+    batch->count = 0;
+
+    ShaderUse(Graphics()->builtinShaders[batch->shader]);
+    SetUniform1i("tex0", 0);
+    TextureUse((Texture){.id = batch->texture}, 0);
+
+    glBindVertexArray(batch->vao);
+    LOG_GL_ERROR("VAO binding failed");
+    {
+        DrawInstancesFrom(StreamBase(&batch->stream) + batch->stream.used - count, count);
+        LOG_GL_ERROR("Drawing failed");
+    }
+    glBindVertexArray(0);
+}
+
+ShapeBatch NewShapeBatch() {
+    ShapeBatch result = {0};
+
+    glGenVertexArrays(1, &result.vao);
+    glBindVertexArray(result.vao);
+    {
+        LoadSquareBuffers();
+
+        result.stream = NewStreamBuffer(sizeof(ShapeInstance), BATCH_MAX);
+
+        // Per-instance rect, color, rotation/rounding/thickness and shape (locations 2-5)
+        u32 stride = sizeof(ShapeInstance);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(ShapeInstance, rect));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(ShapeInstance, color));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(ShapeInstance, rotation));
+        glEnableVertexAttribArray(5);
+        glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, stride,
+                               (void *)offsetof(ShapeInstance, shape));
+        for (u32 i = 2; i <= 5; i++) glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
 
-        // UV attribute (location = 1)
+    return result;
+}
+
+void ShapePush(ShapeInstance shape) {
+    if (Culled(shape.rect, shape.rotation)) return;
+
+    ShapeBatch *batch = &Graphics()->shapeBatch;
+    if (Graphics()->batch.count || Graphics()->polyBatch.count) FlushBatches();
+
+    ShapeInstance *instance = StreamPush(&batch->stream);
+    if (!instance) {
+        FlushBatches();
+        StreamAdvance(&batch->stream);
+        if (!(instance = StreamPush(&batch->stream))) return;
+    }
+
+    batch->shapes |= 1u << shape.shape;
+    batch->count++;
+    *instance = shape;
+}
+
+intern void FlushShapes() {
+    ShapeBatch *batch = &Graphics()->shapeBatch;
+    if (batch->count == 0) return;
+
+    u32 count     = batch->count;
+    u32 shapes    = batch->shapes;
+    batch->count  = 0;
+    batch->shapes = 0;
+
+    // A single bit set means every instance is the same shape
+    u32 variant = (shapes & (shapes - 1)) ? SHAPE_COUNT
+                                          : (u32)SDL_MostSignificantBitIndex32(shapes);
+    ShaderUse(ShaderVariant(&Graphics()->shapes, variant));
+
+    glBindVertexArray(batch->vao);
+    LOG_GL_ERROR("VAO binding failed");
+    {
+        DrawInstancesFrom(StreamBase(&batch->stream) + batch->stream.used - count, count);
+        LOG_GL_ERROR("Drawing failed");
+    }
+    glBindVertexArray(0);
+}
+
+PolyBatch NewPolyBatch() {
+    PolyBatch result = {0};
+
+    glGenVertexArrays(1, &result.vao);
+    glBindVertexArray(result.vao);
+    {
+        result.stream = NewStreamBuffer(sizeof(PolyVertex), POLY_BATCH_MAX);
+
+        u32 stride = sizeof(PolyVertex);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(PolyVertex, pos));
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(f32), (void *)(2 * sizeof(f32)));
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(PolyVertex, color));
     }
     glBindVertexArray(0);
 
     return result;
 }
 
-VAO LoadLineMesh() {
-    persist float lineVertices[] = {-1, -1, 1, 1};
+void PolyPushTriangle(PolyVertex a, PolyVertex b, PolyVertex c) {
+    PolyBatch *batch = &Graphics()->polyBatch;
+    if (Graphics()->batch.count || Graphics()->shapeBatch.count) FlushBatches();
 
-    VAO result = {0};
-    u32 vbo    = 0;
-    glGenVertexArrays(1, &result.id);
-    glGenBuffers(1, &vbo);
+    PolyVertex *first = StreamPush(&batch->stream);
+    if (!first) {
+        FlushBatches();
+        StreamAdvance(&batch->stream);
+        if (!(first = StreamPush(&batch->stream))) return;
+    }
 
-    glBindVertexArray(result.id);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(lineVertices), lineVertices, GL_STATIC_DRAW);
+    // The region's capacity is a multiple of 3, so the other two fit behind it
+    *first = a;
+    *(PolyVertex *)StreamPush(&batch->stream) = b;
+    *(PolyVertex *)StreamPush(&batch->stream) = c;
+    batch->count += 3;
+}
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+intern void FlushPolys() {
+    PolyBatch *batch = &Graphics()->polyBatch;
+    if (batch->count == 0) return;
+
+    u32 count    = batch->count;
+    batch->count = 0;
 
+    ShaderUse(Graphics()->builtinShaders[SHADER_Poly]);
+    glBindVertexArray(batch->vao);
+    LOG_GL_ERROR("VAO binding failed");
+    {
+        glDrawArrays(GL_TRIANGLES, (i32)(StreamBase(&batch->stream) + batch->stream.used - count),
+                     (i32)count);
+        LOG_GL_ERROR("Drawing failed");
+    }
+    glBindVertexArray(0);
+}
+
+// Only one of the queues is ever non-empty, since pushing to one flushes the others
+void FlushBatches() {
+    FlushSprites();
+    FlushShapes();
+    FlushPolys();
+}
+
+DynamicResolution NewDynamicResolution(bool enabled) {
+    DynamicResolution result = {.enabled = enabled};
+    if (enabled) glGenQueries(DYNRES_QUERIES, result.queries);
     return result;
 }
 
+intern void DynamicResolutionBegin(DynamicResolution *dyn) {
+    if (!dyn->enabled) return;
+    glBeginQuery(GL_TIME_ELAPSED, dyn->queries[dyn->frame % DYNRES_QUERIES]);
+}
+
+intern void DynamicResolutionEnd(DynamicResolution *dyn, RenderGraph *graph) {
+    if (!dyn->enabled) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    if (++dyn->frame < DYNRES_QUERIES) return;
+
+    // The query begun next is the oldest one in flight
+    u32 query     = dyn->queries[dyn->frame % DYNRES_QUERIES];
+    i32 available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    u64 ns = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+    dyn->gpuMs = (f32)ns / 1000000.0f;
+
+    // Fill cost goes with the area, so the side scales with the square root of the ratio.
+    // Only a tenth of the way there each frame, so one slow frame doesn't make the image pump.
+    f32 budgetMs = Timing()->targetSpf * 1000.0f * DYNRES_HEADROOM;
+    if (budgetMs <= 0) return;
+    f32 wanted   = graph->renderScale * sqrtf(budgetMs / MAX(dyn->gpuMs, 0.01f));
+    wanted       = MIN(MAX(wanted, DYNRES_MIN_SCALE), 1.0f);
+    graph->renderScale += (wanted - graph->renderScale) * 0.1f;
+}
+
+void ScenePass(const RenderPass *pass) {
+    Graphics()->draw();
+    CameraEnd();
+}
+
+#define BLOOM_LEVELS 4
+
+// Matches the BLOOM_* defines in bloom.frag
+typedef enum { BLOOM_EXTRACT, BLOOM_DOWN, BLOOM_BLUR_H, BLOOM_BLUR_V, BLOOM_UP } BloomPass;
+
+intern Shader BloomShader(BloomPass pass) {
+    persist cstr defines[] = {"#define BLOOM_PASS 0\n", "#define BLOOM_PASS 1\n",
+                              "#define BLOOM_PASS 2\n", "#define BLOOM_PASS 3\n",
+                              "#define BLOOM_PASS 4\n"};
+    return ShaderFromPathDefines("shaders\\post.vert", "shaders\\bloom.frag", defines[pass]);
+}
+
+// The bright parts of the scene are downsampled from 1/2 to 1/(2^BLOOM_LEVELS) resolution,
+// each level gets a separable blur, and the levels are added back up from the smallest. The
+// wide blur comes from the small levels, so it costs a fraction of one at full resolution.
+// Every level shares the same five programs.
+intern RenderTarget AddBloomPasses(RenderGraph *graph, RenderTarget scene) {
+    persist char names[BLOOM_LEVELS][4][16]; // Down, horizontal blur, blur, up
+
+    Shader shaders[BLOOM_UP + 1];
+    for (i32 i = 0; i <= BLOOM_UP; i++) shaders[i] = BloomShader(i);
+
+    RenderTarget down[BLOOM_LEVELS], blur[BLOOM_LEVELS];
+    for (u32 i = 0; i < BLOOM_LEVELS; i++) {
+        SDL_snprintf(names[i][0], 16, "bloomDown%u", i);
+        SDL_snprintf(names[i][1], 16, "bloomBlurH%u", i);
+        SDL_snprintf(names[i][2], 16, "bloomBlur%u", i);
+        SDL_snprintf(names[i][3], 16, "bloomUp%u", i);
+
+        RenderTargetDesc desc = {.scale = 1.0f / (f32)(2u << i), .format = GL_RGBA16F};
+        desc.name             = names[i][0];
+        down[i]               = RenderGraphTarget(graph, desc);
+        desc.name             = names[i][1];
+        RenderTarget blurH    = RenderGraphTarget(graph, desc);
+        desc.name             = names[i][2];
+        blur[i]               = RenderGraphTarget(graph, desc);
+
+        RenderGraphPass(graph, (RenderPass){
+            .name   = names[i][0],
+            .inputs = {i ? down[i - 1] : scene},
+            .output = down[i],
+            .shader = shaders[i ? BLOOM_DOWN : BLOOM_EXTRACT],
+        });
+        RenderGraphPass(graph, (RenderPass){
+            .name   = names[i][1],
+            .inputs = {down[i]},
+            .output = blurH,
+            .shader = shaders[BLOOM_BLUR_H],
+        });
+        RenderGraphPass(graph, (RenderPass){
+            .name   = names[i][2],
+            .inputs = {blurH},
+            .output = blur[i],
+            .shader = shaders[BLOOM_BLUR_V],
+        });
+    }
+
+    RenderTarget up = blur[BLOOM_LEVELS - 1];
+    for (i32 i = BLOOM_LEVELS - 2; i >= 0; i--) {
+        RenderTargetDesc desc = {
+            .name   = names[i][3],
+            .scale  = 1.0f / (f32)(2u << i),
+            .format = GL_RGBA16F,
+        };
+        RenderTarget next = RenderGraphTarget(graph, desc);
+        RenderGraphPass(graph, (RenderPass){
+            .name   = names[i][3],
+            .inputs = {blur[i], up},
+            .output = next,
+            .shader = shaders[BLOOM_UP],
+        });
+        up = next;
+    }
+
+    return up;
+}
+
 GraphicsCtx InitGraphics(WindowCtx *ctx, const GameSettings *settings) {
     GraphicsCtx result = {0};
 
     result.builtinShaders[SHADER_Default] = ShaderFromPath(0, 0);
-    result.builtinShaders[SHADER_Rect] =
-        ShaderFromPath("shaders\\default2d.vert", "shaders\\rect.frag");
-    result.builtinShaders[SHADER_Circle] =
-        ShaderFromPath("shaders\\default2d.vert", "shaders\\circle.frag");
-    result.builtinShaders[SHADER_Sdf] =
-        ShaderFromPath("shaders\\shapes.vert", "shaders\\shapes.frag");
     result.builtinShaders[SHADER_Tiles] =
         ShaderFromPath("shaders\\default2d.vert", "shaders\\tiles.frag");
+    result.builtinShaders[SHADER_Sprite] =
+        ShaderFromPath("shaders\\sprite.vert", "shaders\\sprite.frag");
+    result.builtinShaders[SHADER_Text] =
+        ShaderFromPath("shaders\\sprite.vert", "shaders\\text.frag");
+    result.builtinShaders[SHADER_Poly] =
+        ShaderFromPath("shaders\\color.vert", "shaders\\color.frag");
+
+    result.shapes =
+        NewShaderVariants("shaders\\shapes.vert", "shaders\\shapes.frag", "SHAPE");
 
     result.builtinVAOs[VAO_CUBE]   = LoadSquareMesh();
     result.builtinVAOs[VAO_SQUARE] = LoadSquareMesh();
-    result.builtinVAOs[VAO_LINE]   = LoadLineMesh();
 
-    result.postprocessing = NewFramebuffer("shaders\\post.frag");
+    result.batch      = NewSpriteBatch();
+    result.shapeBatch = NewShapeBatch();
+    result.polyBatch  = NewPolyBatch();
+    result.graph      = SDL_malloc(sizeof(RenderGraph));
+    *result.graph     = NewRenderGraph();
+    result.dynRes     = NewDynamicResolution(settings->dynamicResolution);
+    result.particles  = SDL_malloc(sizeof(ParticleShaders));
+    *result.particles = NewParticleShaders();
+
+    // The game draws into "scene", which the "post" pass puts on the window. Games chain more
+    // passes by adding targets and replacing "post" with one that reads their output.
+    RenderTargetDesc sceneDesc = {
+        .name    = "scene",
+        .scale   = settings->renderScale,
+        .depth   = true,
+        .dynamic = settings->dynamicResolution,
+    };
+    RenderTarget     scene     = RenderGraphTarget(result.graph, sceneDesc);
+    RenderGraphPass(result.graph, (RenderPass){
+        .name       = "scene",
+        .kind       = PASS_SCENE,
+        .output     = scene,
+        .clear      = true,
+        .clearColor = {0.3f, 0.4f, 0.4f, 1.0f},
+    });
+    if (settings->lighting) {
+        result.lighting  = SDL_malloc(sizeof(Lighting));
+        *result.lighting = NewLighting();
+        scene            = AddLightPasses(result.graph, scene, sceneDesc);
+    }
+    RenderPass post = {.name = "post", .inputs = {scene}, .output = RT_WINDOW, .clear = true};
+    if (settings->bloom) {
+        post.inputs[1] = AddBloomPasses(result.graph, scene);
+        post.shader    = ShaderFromPathDefines("shaders\\post.vert", "shaders\\post.frag",
+                                               "#define BLOOM\n");
+    } else {
+        post.shader = ShaderFromPath("shaders\\post.vert", "shaders\\post.frag");
+    }
+    RenderGraphPass(result.graph, post);
+#ifdef DEBUG
+    result.debug  = SDL_malloc(sizeof(DebugDraw));
+    *result.debug = NewDebugDraw();
+    AddDebugPass(result.graph);
+#endif
+
+    // Sprite 0 is a white texel, so untextured quads can share the atlas page
+    persist u32 white = 0xFFFFFFFF;
+    result.atlas      = SDL_malloc(sizeof(Atlas));
+    *result.atlas     = NewAtlas((v2i){2048, 2048}, 1, 1024);
+    AtlasAddPixels(result.atlas, &white, (v2i){1, 1});
+    result.anims  = SDL_malloc(sizeof(AnimLibrary));
+    *result.anims = NewAnimLibrary(result.atlas, 256, 4096);
+
+    result.fonts = SDL_calloc(MAX_FONTS, sizeof(Font));
 
     SDL_CHECK(TTF_Init(), "Failed to initialize SDL_TTF");
 
@@ -453,52 +1182,22 @@ GraphicsCtx InitGraphics(WindowCtx *ctx, const GameSettings *settings) {
 }
 
 void UpdateGraphics(GraphicsCtx *ctx, void (*draw)()) {
+    CameraSet(ctx->cam);
     ShaderUse(Graphics()->builtinShaders[0]);
 
-    ShaderReload(&ctx->postprocessing.shader);
-    for (i32 i = 0; i < SHADER_COUNT; i++) ShaderReload(&ctx->builtinShaders[i]);
-    Framebufferuse(ctx->postprocessing);
-    {
-        ClearScreen((v4){0.3f, 0.4f, 0.4f, 1.0f});
-        draw();
-        CameraEnd();
-    }
-    FramebufferDraw(ctx->postprocessing);
-}
+    ctx->draw = draw;
+    DynamicResolutionBegin(&ctx->dynRes);
+    RenderGraphExecute(ctx->graph);
+    DynamicResolutionEnd(&ctx->dynRes, ctx->graph);
 
-typedef struct {
-    u64       length;
-    i32       wrap;
-    TTF_Font *font;
-    Texture   tex;
-} Text;
-
-Text NewText(cstr text, cstr fontPath, f32 size, i32 wrapChars) {
-    Text result = {.length = 0,
-                   .wrap   = wrapChars * size,
-                   .font   = TTF_OpenFont(fontPath, size),
-                   .tex    = (Texture){0}};
-    SDL_CHECK(result.font, "Failed to open font");
-
-    SDL_Surface *rendered = TTF_RenderText_Blended_Wrapped( // TODO Remove allocation
-        result.font, text, result.length, (SDL_Color){255, 255, 255, 255}, result.wrap);
-    SDL_CHECK(rendered, "Failed to render text");
-    rendered = SDL_ConvertSurface(
-        rendered, SDL_PIXELFORMAT_ABGR8888); // TODO Leaks memory from the first rendered
-    SDL_CHECK(rendered, "Failed to convert surface format");
-
-    glGenTextures(1, &result.tex.id);
-    glBindTexture(GL_TEXTURE_2D, result.tex.id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rendered->w, rendered->h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                 rendered->pixels);
-    result.tex.size = (v2i){rendered->w, rendered->h};
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    SDL_DestroySurface(rendered);
-    return result;
-}
+    StreamAdvance(&ctx->batch.stream);
+    StreamAdvance(&ctx->shapeBatch.stream);
+    StreamAdvance(&ctx->polyBatch.stream);
+    if (ctx->lighting) ResetLights(ctx->lighting);
+#ifdef DEBUG
+    UpdateDebugDraw(ctx->debug);
+#endif
 
-void DrawText(Text text, v2 pos) {
-    DrawTexture(text.tex, pos, 0);
-}
\ No newline at end of file
+    ctx->lastCull = ctx->cull;
+    ctx->cull     = (CullStats){0};
+}
@@ -9,36 +9,84 @@ typedef struct {
 } Camera;
 void CameraBegin(Camera cam);
 void CameraEnd();
+f32  CameraScale(Camera cam);
+Rect CameraViewRect(Camera cam);
+
+// Zooms and rotates around the center of the screen. Shaders get the view-projection as the
+// viewProj uniform, and the conversions below use the same matrix, so picking matches.
+m3 CameraViewProj(Camera cam); // World to clip space
+v2 WorldToScreen(Camera cam, v2 world);
+v2 ScreenToWorld(Camera cam, v2 screen);
+
+// Sprites and shapes outside the active camera's view are dropped before reaching the
+// batches. The test is done in camera space, where the view is an axis aligned rect.
+typedef struct {
+    v2  center, half; // Of the view, in world units
+    f32 cos, sin;     // Of the camera's rotation
+} CullView;
+
+typedef struct {
+    u32 drawn, culled;
+} CullStats;
+bool      Culled(Rect rect, f32 rotation); // Center and size, counted in the stats
+CullStats GetCullStats();                  // Last frame's
+
+// Shader sources go through a small preprocessor first: `#include "file"` pastes a file (once,
+// relative to the including one) and defines are injected after #version. Permutations of
+// one source are built from a key that gets defined to the variant index.
+#define SHADER_MAX_FILES 16
+#define SHADER_MAX_VARIANTS 16
+#define SHADER_MAX_INCLUDE_DEPTH 8
 
 typedef struct {
     u32 id;
 #ifdef DEBUG
-    cstr vertPath, fragPath;
-    u64  vertWrite, fragWrite;
+    cstr vertPath, fragPath, compPath, defines;
+    u64  files[SHADER_MAX_FILES]; // Path hashes of everything the sources pulled in
+    u32  fileCount;
 #endif
 } Shader;
+
+// Linked programs are saved to SHADER_CACHE_DIR, named after a hash of their source and the
+// GL driver, and loaded back with glProgramBinary instead of compiling on the next run
+#define SHADER_CACHE_DIR "cache"
+#define SHADER_CACHE_MAGIC 0x42534848 // "HHSB"
+#define SHADER_CACHE_VERSION 1
+
+typedef struct {
+    u32 magic, version;
+    u64 hash;
+    u32 format, len;
+} ShaderCacheHeader;
 Shader ShaderFromPath(cstr vertFile, cstr fragFile);
+Shader ShaderFromPathDefines(cstr vertFile, cstr fragFile, cstr defines);
+Shader ComputeShaderFromPath(cstr compFile, cstr defines);
 void   ShaderUse(Shader shader);
 void   ShaderReload(Shader *shader);
+bool   ShaderUsesFile(const Shader *shader, cstr path);
 void   ShaderPrintError(u32 shader, char* shaderPath);
 void   ShaderPrintProgramError(u32 program);
 void   SetUniform1i(cstr name, i32 value);
 void   SetUniform2i(cstr name, v2i value);
 void   SetUniform1f(cstr name, f32 value);
 void   SetUniform1fv(cstr name, f32 *value, u64 count);
+void   SetUniform1uiv(cstr name, u32 *value, u64 count);
+void   SetUniform4uiv(cstr name, u32 *value, u64 count);
 void   SetUniform2f(cstr name, v2 value);
 void   SetUniform3f(cstr name, v3 value);
 void   SetUniform4f(cstr name, v4 value);
 void   SetUniform1b(cstr name, bool value);
+void   SetUniformM3(cstr name, m3 value);
 
+// Variants are compiled the first time they're asked for
 typedef struct {
-    u32    fbo, tex, rbo, vao;
-    Shader shader;
-} Framebuffer;
-Framebuffer NewFramebuffer(const cstr fragPath);
-void        Framebufferuse(Framebuffer shader);
-void        FramebufferDraw(Framebuffer shader);
-void        FramebufferResize(Framebuffer shader);
+    cstr   vertPath, fragPath, key;
+    Shader variants[SHADER_MAX_VARIANTS];
+    char   defines[SHADER_MAX_VARIANTS][64];
+    u32    built;
+} ShaderVariants;
+ShaderVariants NewShaderVariants(cstr vertPath, cstr fragPath, cstr key);
+Shader         ShaderVariant(ShaderVariants *set, u32 variant);
 
 typedef struct Texture {
     u32 id;
@@ -51,14 +99,14 @@ void    TextureUse(Texture tex, u32 i);
 
 typedef enum {
     SHADER_Default,
-    SHADER_Rect,
-    SHADER_Circle,
-    SHADER_Sdf,
     SHADER_Tiles,
+    SHADER_Sprite,
+    SHADER_Text,
+    SHADER_Poly,
     SHADER_COUNT,
 } BuiltinShaders;
 
-typedef enum { VAO_CUBE, VAO_SQUARE, VAO_LINE, VAO_COUNT } BuiltinVAOs;
+typedef enum { VAO_CUBE, VAO_SQUARE, VAO_COUNT } BuiltinVAOs;
 
 typedef struct {
     u32 id;
@@ -69,13 +117,141 @@ typedef enum {
     TEX_COUNT,
 } BuiltinTextures;
 
+// Dynamic vertex data is written straight into a persistently mapped buffer, split into
+// STREAM_REGIONS regions that the GPU reads in turn. A region is fenced when the CPU moves
+// past it and waited on before it's written again, so the driver never orphans or copies.
+#define STREAM_REGIONS 3
+
+typedef struct {
+    u32    vbo;
+    u8    *mapped;
+    u32    stride, capacity; // Capacity in elements per region
+    u32    region, used;
+    GLsync fences[STREAM_REGIONS];
+} StreamBuffer;
+StreamBuffer NewStreamBuffer(u32 stride, u32 capacity);
+void        *StreamPush(StreamBuffer *stream);
+u32          StreamBase(const StreamBuffer *stream);
+void         StreamAdvance(StreamBuffer *stream);
+
+// Textured quads are queued here and drawn with one instanced call per texture run. The
+// queue is flushed when the texture or camera changes and before any immediate draw.
+// Instances go straight into the batch's stream, whose regions hold BATCH_MAX each.
+#define BATCH_MAX 16384
+
+typedef struct {
+    Rect rect; // Center and size
+    Rect uv;
+    v4   color;
+    f32  rotation;
+} SpriteInstance;
+
+typedef struct {
+    u32          vao;
+    StreamBuffer stream;
+    u32          texture, shader;
+    u32          count; // The last count instances in the stream's region
+} SpriteBatch;
+void BatchPush(u32 texture, Rect dst, Rect uv, v4 color, f32 rotation);
+void BatchPushShader(BuiltinShaders shader, u32 texture, Rect dst, Rect uv, v4 color,
+                     f32 rotation);
+void FlushBatches();
+
+// Matches the SHAPE_* defines in shapes.frag
+typedef enum {
+    SHAPE_RECT,
+    SHAPE_LINE,
+    SHAPE_CIRCLE,
+    SHAPE_HEXAGON,
+    SHAPE_TRIANGLE,
+    SHAPE_COUNT
+} Shapes;
+
+// SDF shapes get their own instanced queue, so any mix of them is one draw. A batch of a
+// single shape uses the variant of shapes.frag compiled for it, and a mixed one variant
+// SHAPE_COUNT (SHAPE_ANY there), which reads the shape from the instance.
+typedef struct {
+    Rect rect; // Center and size
+    v4   color;
+    f32  rotation;
+    f32  rounding;  // [0, 1] of the shorter half side
+    f32  thickness; // Outline width, 0 to fill
+    u32  shape;
+} ShapeInstance;
+
+typedef struct {
+    u32          vao;
+    StreamBuffer stream;
+    u32          count;
+    u32          shapes; // Bitmask of the Shapes queued
+} ShapeBatch;
+void ShapePush(ShapeInstance shape);
+
+// Polylines and polygons (see tessellate.h) are tessellated on the CPU into plain triangles,
+// which are queued here and drawn with one non-indexed call. Pushes are whole triangles and
+// a region holds a whole number of them, so a triangle never straddles two.
+#define POLY_BATCH_MAX (3 * 32768) // Vertices
+
+typedef struct {
+    v2 pos;
+    v4 color;
+} PolyVertex;
+
+typedef struct {
+    u32          vao;
+    StreamBuffer stream;
+    u32          count; // Vertices
+} PolyBatch;
+void PolyPushTriangle(PolyVertex a, PolyVertex b, PolyVertex c);
+
+// With dynamic resolution the scene is drawn at a scale adjusted every frame, so the GPU time
+// measured with timer queries stays under the frame budget. Queries are read DYNRES_QUERIES
+// frames late, so their results are in and reading them never stalls.
+#define DYNRES_QUERIES 4
+#define DYNRES_MIN_SCALE 0.5f
+#define DYNRES_HEADROOM 0.85f // Of the frame budget, left for the CPU side and vsync jitter
+
+typedef struct {
+    bool enabled;
+    u32  queries[DYNRES_QUERIES];
+    u32  frame;
+    f32  gpuMs; // Last measured
+} DynamicResolution;
+DynamicResolution NewDynamicResolution(bool enabled);
+
+typedef struct AnimLibrary     AnimLibrary;
+typedef struct Atlas           Atlas;
+typedef struct DebugDraw       DebugDraw;
+typedef struct Font            Font;
+typedef struct Lighting        Lighting;
+typedef struct ParticleShaders ParticleShaders;
+typedef struct RenderGraph     RenderGraph;
+
 struct GraphicsCtx {
-    Camera      cam;
-    u32         activeShader;
-    Shader      builtinShaders[SHADER_COUNT];
-    Texture     builtinTextures[TEX_COUNT];
-    VAO         builtinVAOs[VAO_COUNT];
-    Framebuffer postprocessing;
+    Camera            cam, sceneCam;
+    m3                viewProj; // Of cam
+    CullView          cullView;
+    CullStats         cull, lastCull;
+    u32               activeShader;
+    Shader            builtinShaders[SHADER_COUNT];
+    ShaderVariants    shapes;
+    Texture           builtinTextures[TEX_COUNT];
+    VAO               builtinVAOs[VAO_COUNT];
+    RenderGraph      *graph;
+    Lighting         *lighting; // When enabled in the settings
+    ParticleShaders  *particles;
+#ifdef DEBUG
+    DebugDraw *debug;
+#endif
+    DynamicResolution dynRes;
+    void (*draw)(); // The game's, run by the scene pass
+    SpriteBatch       batch;
+    ShapeBatch        shapeBatch;
+    PolyBatch         polyBatch;
+    Atlas            *atlas;
+    AnimLibrary      *anims;
+    Font             *fonts;
+    u32               fontCount;
 };
 intern GraphicsCtx InitGraphics(WindowCtx *ctx, const GameSettings *settings);
 intern void        UpdateGraphics(GraphicsCtx *ctx, void (*draw)());
@@ -86,10 +262,14 @@ v2   MouseDir();
 v2   MouseInWorld(Camera cam);
 void ClearScreen(v4 color);
 void DrawInstances(u32 count);
+void DrawInstancesFrom(u32 first, u32 count);
 void DrawElement();
-void DrawRectangle(Rect rect, f32 rotation, v4 color, f32 rounding);
+void DrawRectangle(Rect rect, f32 rotation, v4 color, f32 rounding); // Rounding as in DrawShape
 void DrawLine(v2 from, v2 to, v4 color);
 void DrawCircle(v2 center, f32 radius, v4 color, bool line, f32 thickness);
+void DrawHexagon(v2 center, f32 radius, f32 rotation, v4 color);
+void DrawThickLine(v2 from, v2 to, f32 thickness, v4 color);
+void DrawShape(Shapes shape, Rect rect, f32 rotation, v4 color, f32 rounding, f32 thickness);
 void DrawPoly(Poly poly, v4 color);
 
 #define COLOR_NULL (v4){0, 0, 0, 0}
@@ -0,0 +1,309 @@
+#include "lights.h"
+
+Lighting NewLighting() {
+    Lighting result = {.ambient = {0.15f, 0.15f, 0.2f, 1}};
+
+    // Rows wrap around horizontally, since both ends are the angle behind the light
+    glGenTextures(1, &result.shadowTex);
+    glBindTexture(GL_TEXTURE_2D, result.shadowTex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, SHADOW_RES, MAX_LIGHTS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &result.shadowFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, result.shadowFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, result.shadowTex,
+                           0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG_ERROR("Shadow map framebuffer is incomplete");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &result.shadowVao);
+    glBindVertexArray(result.shadowVao);
+    {
+        LoadSquareBuffers();
+
+        result.shadowStream = NewStreamBuffer(sizeof(ShadowInstance), SHADOW_BATCH);
+
+        // Per-instance segment, light and span (locations 2-4)
+        u32 stride = sizeof(ShadowInstance);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(ShadowInstance, segment));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(ShadowInstance, light));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(ShadowInstance, span));
+        for (u32 i = 2; i <= 4; i++) glVertexAttribDivisor(i, 1);
+    }
+
+    glGenVertexArrays(1, &result.lightVao);
+    glBindVertexArray(result.lightVao);
+    {
+        LoadSquareBuffers();
+
+        result.lightStream = NewStreamBuffer(sizeof(Light), MAX_LIGHTS);
+
+        // Per-instance position/radius/direction, color and cone (locations 2-4)
+        u32 stride = sizeof(Light);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(Light, pos));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(Light, color));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(Light, cone));
+        for (u32 i = 2; i <= 4; i++) glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+
+    result.shadowShader = ShaderFromPath("shaders\\shadow.vert", "shaders\\shadow.frag");
+    result.lightShader  = ShaderFromPath("shaders\\lights.vert", "shaders\\lights.frag");
+
+    return result;
+}
+
+void DrawLight(Light light) {
+    Lighting *lighting = Graphics()->lighting;
+    if (!lighting || lighting->lightCount == MAX_LIGHTS) return;
+
+    Rect bounds = {light.pos.x, light.pos.y, light.radius * 2, light.radius * 2};
+    if (Culled(bounds, 0)) return;
+
+    lighting->lights[lighting->lightCount++] = light;
+}
+
+void AddOccluder(v2 a, v2 b) {
+    Lighting *lighting = Graphics()->lighting;
+    if (!lighting || lighting->occluderCount == MAX_OCCLUDERS) return;
+
+    lighting->occluders[lighting->occluderCount++] = (Occluder){a, b};
+}
+
+void AddOccluderRect(Rect rect) {
+    v2 corners[4] = {
+        {rect.x, rect.y},
+        {rect.x + rect.w, rect.y},
+        {rect.x + rect.w, rect.y + rect.h},
+        {rect.x, rect.y + rect.h},
+    };
+    for (u32 i = 0; i < 4; i++) AddOccluder(corners[i], corners[(i + 1) % 4]);
+}
+
+void SetAmbientLight(v4 color) {
+    if (Graphics()->lighting) Graphics()->lighting->ambient = color;
+}
+
+intern bool TileSolid(const Tilemap *map, u32 layer, i32 x, i32 y) {
+    if (x < 0 || y < 0 || x >= map->size.w || y >= map->size.h) return false;
+    return TilemapGet(map, layer, (v2i){x, y}) != TILE_EMPTY;
+}
+
+void TilemapOccluders(const Tilemap *map, Tileset set, v2 pos, u32 layer) {
+    if (!Graphics()->lighting || layer >= map->layers) return;
+
+    // Half a view of margin, so lights just off screen still cast shadows into it
+    v2   tile = {(f32)set.tileSize.w, (f32)set.tileSize.h};
+    Rect view = CameraViewRect(Graphics()->cam);
+    i32  x0   = MAX((i32)floorf((view.x - view.w * 0.5f - pos.x) / tile.w), 0);
+    i32  y0   = MAX((i32)floorf((view.y - view.h * 0.5f - pos.y) / tile.h), 0);
+    i32  x1   = MIN((i32)floorf((view.x + view.w * 1.5f - pos.x) / tile.w), map->size.w - 1);
+    i32  y1   = MIN((i32)floorf((view.y + view.h * 1.5f - pos.y) / tile.h), map->size.h - 1);
+    if (x0 > x1 || y0 > y1) return;
+
+    // Top and bottom edges along each row, then left and right ones along each column.
+    // Consecutive exposed edges are merged, so a straight wall is a single segment.
+    for (i32 y = y0; y <= y1; y++) {
+        for (i32 side = 0; side < 2; side++) {
+            f32 edge  = pos.y + (y + side) * tile.h;
+            i32 start = -1;
+            for (i32 x = x0; x <= x1 + 1; x++) {
+                bool exposed = x <= x1 && TileSolid(map, layer, x, y) &&
+                               !TileSolid(map, layer, x, side ? y + 1 : y - 1);
+                if (exposed && start < 0) start = x;
+                if (exposed || start < 0) continue;
+
+                AddOccluder((v2){pos.x + start * tile.w, edge}, (v2){pos.x + x * tile.w, edge});
+                start = -1;
+            }
+        }
+    }
+    for (i32 x = x0; x <= x1; x++) {
+        for (i32 side = 0; side < 2; side++) {
+            f32 edge  = pos.x + (x + side) * tile.w;
+            i32 start = -1;
+            for (i32 y = y0; y <= y1 + 1; y++) {
+                bool exposed = y <= y1 && TileSolid(map, layer, x, y) &&
+                               !TileSolid(map, layer, side ? x + 1 : x - 1, y);
+                if (exposed && start < 0) start = y;
+                if (exposed || start < 0) continue;
+
+                AddOccluder((v2){edge, pos.y + start * tile.h}, (v2){edge, pos.y + y * tile.h});
+                start = -1;
+            }
+        }
+    }
+}
+
+intern f32 SegmentDistanceSq(v2 p, v2 a, v2 b) {
+    v2  ab  = v2Sub(b, a);
+    v2  ap  = v2Sub(p, a);
+    f32 len = ab.x * ab.x + ab.y * ab.y;
+    f32 t   = len > 0 ? MIN(MAX((ap.x * ab.x + ap.y * ab.y) / len, 0), 1) : 0;
+    v2  d   = v2Sub(ap, v2Scale(ab, t));
+    return d.x * d.x + d.y * d.y;
+}
+
+intern void FlushShadows(Lighting *lighting, u32 *count) {
+    if (*count == 0) return;
+
+    glBindVertexArray(lighting->shadowVao);
+    DrawInstancesFrom(StreamBase(&lighting->shadowStream) + lighting->shadowStream.used - *count,
+                      *count);
+    LOG_GL_ERROR("Drawing failed");
+    *count = 0;
+}
+
+intern void PushShadow(Lighting *lighting, u32 *count, ShadowInstance shadow) {
+    ShadowInstance *instance = StreamPush(&lighting->shadowStream);
+    if (!instance) {
+        FlushShadows(lighting, count);
+        StreamAdvance(&lighting->shadowStream);
+        if (!(instance = StreamPush(&lighting->shadowStream))) return;
+    }
+
+    *instance = shadow;
+    (*count)++;
+}
+
+// Every occluder within reach of a light is drawn over the span of angles it covers in the
+// light's row, split in two when it crosses the seam behind the light. shadow.frag writes the
+// exact hit distance per texel and GL_MIN blending keeps the closest.
+intern void BuildShadowMaps(Lighting *lighting) {
+    i32 framebuffer = 0, viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, lighting->shadowFbo);
+    glViewport(0, 0, SHADOW_RES, MAX_LIGHTS);
+    ClearScreen((v4){1, 1, 1, 1});
+    glBlendEquation(GL_MIN);
+
+    ShaderUse(lighting->shadowShader);
+    SetUniform2f("shadowSize", (v2){SHADOW_RES, MAX_LIGHTS});
+
+    u32 count = 0;
+    for (u32 i = 0; i < lighting->lightCount; i++) {
+        Light light  = lighting->lights[i];
+        f32   reach  = light.radius * light.radius;
+        v4    params = {light.pos.x, light.pos.y, light.radius, (f32)i};
+
+        for (u32 j = 0; j < lighting->occluderCount; j++) {
+            Occluder occluder = lighting->occluders[j];
+            if (SegmentDistanceSq(light.pos, occluder.a, occluder.b) > reach) continue;
+
+            f32 from = Angle(v2Sub(occluder.a, light.pos)) / TAU + 0.5f;
+            f32 to   = Angle(v2Sub(occluder.b, light.pos)) / TAU + 0.5f;
+            if (from > to) {
+                f32 swap = from;
+                from     = to;
+                to       = swap;
+            }
+
+            ShadowInstance shadow = {
+                .segment = {occluder.a.x, occluder.a.y, occluder.b.x, occluder.b.y},
+                .light   = params,
+            };
+            if (to - from <= 0.5f) {
+                shadow.span = (v2){from, to};
+                PushShadow(lighting, &count, shadow);
+            } else {
+                shadow.span = (v2){to, 1};
+                PushShadow(lighting, &count, shadow);
+                shadow.span = (v2){0, from};
+                PushShadow(lighting, &count, shadow);
+            }
+        }
+    }
+    FlushShadows(lighting, &count);
+    glBindVertexArray(0);
+
+    glBlendEquation(GL_FUNC_ADD);
+    glBindFramebuffer(GL_FRAMEBUFFER, (u32)framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void LightsPass(const RenderPass *pass) {
+    Lighting *lighting = Graphics()->lighting;
+    ClearScreen(lighting->ambient);
+    if (lighting->lightCount == 0) return;
+
+    BuildShadowMaps(lighting);
+
+    // The instance index is the light's row in the shadow map
+    u32 first = StreamBase(&lighting->lightStream) + lighting->lightStream.used;
+    u32 count = 0;
+    for (; count < lighting->lightCount; count++) {
+        Light *instance = StreamPush(&lighting->lightStream);
+        if (!instance) break;
+        *instance = lighting->lights[count];
+    }
+
+    CameraSet(Graphics()->sceneCam);
+    glBlendFunc(GL_ONE, GL_ONE);
+    ShaderUse(lighting->lightShader);
+    SetUniform1i("shadowMap", 0);
+    TextureUse((Texture){.id = lighting->shadowTex}, 0);
+
+    glBindVertexArray(lighting->lightVao);
+    LOG_GL_ERROR("VAO binding failed");
+    {
+        DrawInstancesFrom(first, count);
+        LOG_GL_ERROR("Drawing failed");
+    }
+    glBindVertexArray(0);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    CameraSet((Camera){0});
+}
+
+// "lights" has no inputs, so it runs in declaration order, after the scene has submitted its
+// lights. Both new targets follow the scene's scale and dynamic resolution.
+RenderTarget AddLightPasses(RenderGraph *graph, RenderTarget scene, RenderTargetDesc sceneDesc) {
+    f32          scale  = sceneDesc.scale > 0 ? sceneDesc.scale : 1;
+    RenderTarget lights = RenderGraphTarget(graph, (RenderTargetDesc){
+        .name    = "lights",
+        .scale   = scale * LIGHTS_SCALE,
+        .format  = GL_RGBA16F,
+        .dynamic = sceneDesc.dynamic,
+    });
+    RenderTarget lit    = RenderGraphTarget(graph, (RenderTargetDesc){
+        .name    = "lit",
+        .scale   = scale,
+        .format  = GL_RGBA16F,
+        .dynamic = sceneDesc.dynamic,
+    });
+
+    RenderGraphPass(graph, (RenderPass){
+        .name   = "lights",
+        .kind   = PASS_LIGHTS,
+        .output = lights,
+    });
+    RenderGraphPass(graph, (RenderPass){
+        .name   = "lit",
+        .inputs = {scene, lights},
+        .output = lit,
+        .shader = ShaderFromPath("shaders\\post.vert", "shaders\\lit.frag"),
+    });
+    return lit;
+}
+
+void ResetLights(Lighting *lighting) {
+    StreamAdvance(&lighting->shadowStream);
+    StreamAdvance(&lighting->lightStream);
+    lighting->lightCount    = 0;
+    lighting->occluderCount = 0;
+}
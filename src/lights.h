@@ -0,0 +1,60 @@
+#pragma once
+
+#include "engine.h"
+#include "graphics.h"
+#include "rendergraph.h"
+#include "tilemap.h"
+
+// Lights and occluder segments are submitted every frame while drawing the scene. The
+// "lights" pass first builds a 1D shadow map per light, one row of SHADOW_RES angles holding
+// the distance to the closest occluder in that direction: every segment near a light is drawn
+// as a span of its row and the nearest hit wins. Lights are then added into a buffer at
+// LIGHTS_SCALE that starts at the ambient color, and the "lit" pass multiplies the scene by
+// it. Each light costs one row and a quad at reduced resolution, whatever its size.
+#define MAX_LIGHTS 256
+#define MAX_OCCLUDERS 4096
+#define SHADOW_RES 512
+#define SHADOW_BATCH 16384 // Light-occluder pairs per stream region
+#define LIGHTS_SCALE 0.5f
+
+typedef struct {
+    v2  pos;
+    f32 radius;
+    f32 direction; // Of spot lights
+    v4  color;     // Alpha is the intensity
+    f32 cone;      // Half the spot's opening angle, 0 (or PI and over) for point lights
+} Light;
+
+typedef struct {
+    v2 a, b;
+} Occluder;
+
+typedef struct {
+    v4 segment; // a, b
+    v4 light;   // Position, radius, shadow map row
+    v2 span;    // Of angles covered, as [0, 1] around the light
+} ShadowInstance;
+
+struct Lighting {
+    Light        lights[MAX_LIGHTS];
+    u32          lightCount;
+    Occluder     occluders[MAX_OCCLUDERS];
+    u32          occluderCount;
+    v4           ambient;
+    u32          shadowFbo, shadowTex;
+    u32          shadowVao, lightVao;
+    StreamBuffer shadowStream, lightStream;
+    Shader       shadowShader, lightShader;
+};
+Lighting     NewLighting();
+RenderTarget AddLightPasses(RenderGraph *graph, RenderTarget scene, RenderTargetDesc sceneDesc);
+void         ResetLights(Lighting *lighting); // At the end of the frame
+
+void DrawLight(Light light);
+void AddOccluder(v2 a, v2 b);
+void AddOccluderRect(Rect rect);
+void SetAmbientLight(v4 color);
+
+// Adds the edges between solid and empty tiles of one layer, merged into runs, around the
+// part of the map in view
+void TilemapOccluders(const Tilemap *map, Tileset set, v2 pos, u32 layer);
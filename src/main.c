@@ -1,7 +1,7 @@
 #include "games/game.c"
 
 i32 main() {
-    E = (EngineCtx *)malloc(128 * 1'000'000);
+    E = (EngineCtx *)malloc(ENGINE_MEMORY_SIZE);
 
     EngineLoadGame(Setup, Init, Update, Draw);
     EngineInit();
@@ -20,6 +20,7 @@ typedef struct GameApi {
     void (*EngineShutdown)();
     bool (*EngineIsRunning)();
     void *(*EngineGetMemory)();
+    uint64_t (*EngineMemorySize)();
     void (*EngineReloadMemory)(void *memory);
     uint64_t (*GetLastWriteTime)(char *file);
 } GameApi;
@@ -61,6 +62,7 @@ GameApi LoadApi(void *memory, int32_t version) {
         .EngineShutdown     = GetProcAddress(lib, "EngineShutdown"),
         .EngineIsRunning    = GetProcAddress(lib, "EngineIsRunning"),
         .EngineGetMemory    = GetProcAddress(lib, "EngineGetMemory"),
+        .EngineMemorySize   = GetProcAddress(lib, "EngineMemorySize"),
         .EngineReloadMemory = GetProcAddress(lib, "EngineReloadMemory"),
         .GetLastWriteTime   = GetProcAddress(lib, "GetLastWriteTime"),
     };
@@ -68,6 +70,14 @@ GameApi LoadApi(void *memory, int32_t version) {
 
     api.writeTime = api.GetLastWriteTime(dllBuf);
 
+    // The first load allocates the engine's block, sized by the dll
+    if (!memory) {
+        memory = VirtualAlloc(0, api.EngineMemorySize(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (!memory) {
+            printf("[Fatal] [%s] VirtualAlloc failed: %d\n", __func__, GetLastError());
+            return (GameApi){0};
+        }
+    }
     api.EngineReloadMemory(memory);
     api.EngineLoadGame(api.Setup, api.Init, api.Update, api.Draw);
 
@@ -89,8 +99,7 @@ void ReloadApi(GameApi *api) {
 }
 
 int32_t main() {
-    GameApi api =
-        LoadApi(VirtualAlloc(0, 128 * 1'000'000, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE), 0);
+    GameApi api = LoadApi(0, 0);
     if (!api.lib) return 1;
 
     api.EngineInit();
@@ -0,0 +1,161 @@
+#include "pack.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOUSER
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+intern bool PackMap(PackCtx *pack, cstr path) {
+#ifdef _WIN32
+    pack->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, 0);
+    if (pack->file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(pack->file, &size)) return false;
+    pack->len = (u64)size.QuadPart;
+
+    pack->mapping = CreateFileMappingA(pack->file, 0, PAGE_READONLY, 0, 0, 0);
+    if (!pack->mapping) return false;
+    pack->base = MapViewOfFile(pack->mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    pack->fd = open(path, O_RDONLY);
+    if (pack->fd < 0) return false;
+
+    struct stat fileStat;
+    if (fstat(pack->fd, &fileStat) != 0) return false;
+    pack->len = (u64)fileStat.st_size;
+
+    pack->base = mmap(0, pack->len, PROT_READ, MAP_PRIVATE, pack->fd, 0);
+    if (pack->base == MAP_FAILED) pack->base = 0;
+#endif
+    return pack->base != 0;
+}
+
+PackCtx InitPack(cstr path) {
+    PackCtx result = {0};
+    if (!PackMap(&result, path)) {
+        LOG_INFO("No pack at %s, loading loose files", path);
+        ShutdownPack(&result);
+        return result;
+    }
+
+    const PackHeader *header = (const PackHeader *)result.base;
+    if (result.len < sizeof(PackHeader) || header->magic != PACK_MAGIC ||
+        header->version != PACK_VERSION ||
+        result.len < sizeof(PackHeader) + (u64)header->entryCount * sizeof(PackEntry)) {
+        LOG_ERROR("%s isn't a valid version %d pack, loading loose files", path, PACK_VERSION);
+        ShutdownPack(&result);
+        return result;
+    }
+
+    // Every blob and its terminating zero have to be inside the mapping
+    const PackEntry *entries = (const PackEntry *)(header + 1);
+    for (u32 i = 0; i < header->entryCount; i++) {
+        const PackEntry *entry = &entries[i];
+        if (entry->offset < result.len && entry->len < result.len - entry->offset &&
+            memchr(entry->path, 0, PACK_PATH_MAX))
+            continue;
+
+        LOG_ERROR("%s has a broken entry %u, loading loose files", path, i);
+        ShutdownPack(&result);
+        return result;
+    }
+
+    result.entries    = entries;
+    result.entryCount = header->entryCount;
+    LOG_INFO("Mapped %s: %u assets, %llu bytes", path, result.entryCount,
+             (unsigned long long)result.len);
+
+    return result;
+}
+
+void ShutdownPack(PackCtx *pack) {
+#ifdef _WIN32
+    if (pack->base) UnmapViewOfFile(pack->base);
+    if (pack->mapping) CloseHandle(pack->mapping);
+    if (pack->file && pack->file != INVALID_HANDLE_VALUE) CloseHandle(pack->file);
+#else
+    if (pack->base) munmap((void *)pack->base, pack->len);
+    if (pack->fd > 0) close(pack->fd);
+#endif
+    *pack = (PackCtx){0};
+}
+
+intern bool PackPathEqual(cstr a, cstr b) {
+    for (;; a++, b++) {
+        if (PackPathChar(*a) != PackPathChar(*b)) return false;
+        if (!*a) return true;
+    }
+}
+
+const PackEntry *PackFind(const PackCtx *pack, cstr path) {
+    if (!pack->entries) return 0;
+
+    u64 hash = PackHash(path);
+    u32 lo = 0, hi = pack->entryCount;
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo) / 2;
+        if (pack->entries[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    // The hash only narrows it down, a colliding path must not hand out another asset
+    for (; lo < pack->entryCount && pack->entries[lo].hash == hash; lo++)
+        if (PackPathEqual(pack->entries[lo].path, path)) return &pack->entries[lo];
+    return 0;
+}
+
+const void *PackData(const PackCtx *pack, const PackEntry *entry) {
+    return pack->base + entry->offset;
+}
+
+SDL_Surface *LoadSurface(cstr path) {
+    const PackEntry *entry = PackFind(Pack(), path);
+    if (entry && entry->type == PACK_IMAGE)
+        return SDL_CreateSurfaceFrom(entry->w, entry->h, SDL_PIXELFORMAT_ABGR8888,
+                                     (void *)PackData(Pack(), entry), entry->w * 4);
+
+    SDL_Surface *img = IMG_Load(path);
+    if (!img) {
+        LOG_ERROR("Couldn't load %s: %s", path, SDL_GetError());
+        return 0;
+    }
+
+    SDL_Surface *result = SDL_ConvertSurface(img, SDL_PIXELFORMAT_ABGR8888);
+    SDL_DestroySurface(img);
+    SDL_CHECK(result, "Couldn't convert image");
+    return result;
+}
+
+SDL_IOStream *LoadAssetIO(cstr path) {
+    const PackEntry *entry = PackFind(Pack(), path);
+    if (entry) return SDL_IOFromConstMem(PackData(Pack(), entry), entry->len);
+
+    return SDL_IOFromFile(path, "rb");
+}
+
+string LoadAsset(cstr path) {
+    const PackEntry *entry = PackFind(Pack(), path);
+    if (entry) return (string){.data = (cstr)PackData(Pack(), entry), .len = entry->len};
+
+    return ReadEntireFile(path);
+}
+
+bool PackContains(const PackCtx *pack, const void *ptr) {
+    return (const u8 *)ptr >= pack->base && (const u8 *)ptr < pack->base + pack->len;
+}
+
+void FreeAsset(string asset) {
+    if (!PackContains(Pack(), asset.data)) SDL_free(asset.data);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "common.h"
+
+// A pack is one file with everything under data/ and shaders/, written by tools/packer.c.
+// Images are stored as decoded ABGR8888 pixels and sounds already in the mixing format, so
+// the runtime maps the file and hands out pointers into it without decoding or copying.
+//
+// Layout: PackHeader, PackEntry[entryCount] sorted by hash, then the blobs, each aligned to
+// PACK_ALIGN and followed by at least one zero byte so text assets are valid C strings.
+#define PACK_MAGIC 0x4B504848 // "HHPK"
+#define PACK_VERSION 1
+#define PACK_ALIGN 64
+#define PACK_PATH_MAX 64
+#define PACK_DEFAULT_PATH "data.pack"
+
+typedef enum { PACK_RAW, PACK_IMAGE, PACK_SOUND } PackType;
+
+typedef struct {
+    u32 magic, version, entryCount, _pad;
+} PackHeader;
+
+typedef struct {
+    u64  hash;
+    u64  offset, len;
+    u32  type;
+    i32  w, h; // PACK_IMAGE only
+    u32  _pad;
+    char path[PACK_PATH_MAX];
+} PackEntry;
+
+// Paths are matched case-insensitively and with either slash, since the game code spells
+// them the Windows way.
+inline char PackPathChar(char c) {
+    if (c == '\\') return '/';
+    return c >= 'A' && c <= 'Z' ? c + 'a' - 'A' : c;
+}
+
+inline u64 PackHash(cstr path) {
+    u64 hash = 14695981039346656037ull;
+    for (; *path; path++) hash = (hash ^ (u8)PackPathChar(*path)) * 1099511628211ull;
+    return hash;
+}
+
+typedef struct {
+    const u8        *base;
+    u64              len;
+    const PackEntry *entries;
+    u32              entryCount;
+#ifdef _WIN32
+    void *file, *mapping;
+#else
+    i32 fd;
+#endif
+} PackCtx;
+PackCtx          InitPack(cstr path);
+void             ShutdownPack(PackCtx *pack);
+const PackEntry *PackFind(const PackCtx *pack, cstr path);
+const void      *PackData(const PackCtx *pack, const PackEntry *entry);
+bool             PackContains(const PackCtx *pack, const void *ptr);
+PackCtx         *Pack();
+
+// Asset loading that goes through the pack when it's open and falls back to loose files.
+// Packed results point straight into the mapping and must not be written to.
+SDL_Surface  *LoadSurface(cstr path); // Always ABGR8888
+SDL_IOStream *LoadAssetIO(cstr path);
+string        LoadAsset(cstr path);
+void          FreeAsset(string asset);
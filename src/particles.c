@@ -0,0 +1,105 @@
+#include "particles.h"
+
+ParticleShaders NewParticleShaders() {
+    persist cstr defines[] = {"#define PARTICLE_PASS 0\n", "#define PARTICLE_PASS 1\n",
+                              "#define PARTICLE_PASS 2\n"};
+
+    ParticleShaders result = {0};
+    for (u32 i = 0; i < PARTICLE_PASS_COUNT; i++)
+        result.passes[i] = ComputeShaderFromPath("shaders\\particles.comp", defines[i]);
+    result.draw = ShaderFromPath("shaders\\particles.vert", "shaders\\particles.frag");
+    return result;
+}
+
+ParticleSystem NewParticleSystem(u32 capacity) {
+    ParticleSystem result = {.capacity = capacity};
+
+    glGenBuffers(2, result.buffers);
+    for (u32 i = 0; i < 2; i++) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, result.buffers[i]);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, (u64)capacity * sizeof(Particle), 0, 0);
+    }
+
+    // Nothing alive yet, so the first update simulates zero groups
+    ParticleCounters counters = {.indexCount = 6, .groups = {0, 1, 1}};
+    glGenBuffers(1, &result.counters);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, result.counters);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(counters), &counters, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    result.emits = NewStreamBuffer(sizeof(EmitRequest), PARTICLE_MAX_EMITS);
+    LOG_GL_ERROR("Couldn't create particle buffers");
+
+    return result;
+}
+
+// Emitted on the GPU at the next update, as many as fit next to the particles alive then
+void EmitParticles(ParticleSystem *system, ParticleEmitter emitter, u32 count) {
+    count = MIN(count, system->capacity - system->emitTotal);
+    if (count == 0) return;
+
+    EmitRequest *request = StreamPush(&system->emits);
+    if (!request) return;
+
+    *request = (EmitRequest){.emitter = emitter, .first = system->emitTotal};
+    system->emitCount++;
+    system->emitTotal += count;
+}
+
+void UpdateParticles(ParticleSystem *system, f32 dt) {
+    ParticleShaders *shaders = Graphics()->particles;
+    u32              src     = system->buffers[system->current];
+    u32              dst     = system->buffers[system->current ^ 1];
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, src);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, dst);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, system->counters);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, system->counters);
+
+    ShaderUse(shaders->passes[PARTICLE_SIMULATE]);
+    SetUniform1f("dt", dt);
+    SetUniform2f("gravity", system->gravity);
+    SetUniform1f("drag", system->drag);
+    glDispatchComputeIndirect(offsetof(ParticleCounters, groups));
+
+    if (system->emitCount) {
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, system->emits.vbo,
+                          (i64)StreamBase(&system->emits) * sizeof(EmitRequest),
+                          system->emitCount * sizeof(EmitRequest));
+
+        ShaderUse(shaders->passes[PARTICLE_EMIT]);
+        SetUniform1i("emitCount", (i32)system->emitCount);
+        SetUniform1i("emitTotal", (i32)system->emitTotal);
+        SetUniform1i("seed", (i32)system->seed++);
+        glDispatchCompute((system->emitTotal + PARTICLE_GROUP - 1) / PARTICLE_GROUP, 1, 1);
+    }
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    ShaderUse(shaders->passes[PARTICLE_FINISH]);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    LOG_GL_ERROR("Particle update failed");
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    StreamAdvance(&system->emits);
+    system->emitCount = 0;
+    system->emitTotal = 0;
+    system->current ^= 1;
+}
+
+void DrawParticles(const ParticleSystem *system) {
+    FlushBatches();
+    ShaderUse(Graphics()->particles->draw);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, system->buffers[system->current]);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, system->counters);
+
+    glBindVertexArray(Graphics()->builtinVAOs[VAO_SQUARE].id);
+    LOG_GL_ERROR("VAO binding failed");
+    {
+        glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0);
+        LOG_GL_ERROR("Drawing failed");
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "engine.h"
+#include "graphics.h"
+
+// Particles only ever live on the GPU. Each update a compute pass integrates last frame's
+// particles and appends the survivors to the other buffer of a pair, which compacts them,
+// then another appends the particles emitted since the last update. A one thread pass writes
+// the live count into the arguments of the next update's indirect dispatch and of the draw,
+// so the CPU never reads anything back: a million particles are one dispatch and one draw.
+#define PARTICLE_GROUP 256    // Matches local_size_x in particles.comp
+#define PARTICLE_MAX_EMITS 64 // EmitParticles calls per update
+
+// Matches Particle in particles.glsl (std430)
+typedef struct {
+    v2  pos, vel;
+    v4  color, endColor;
+    f32 size, endSize;
+    f32 age, life;
+} Particle;
+
+// Particles leave pos within spread radians of direction. Speed and life vary by a quarter
+// either way, and color and size go to their end values over each particle's life.
+typedef struct {
+    v2  pos;
+    f32 direction, spread;
+    v4  color, endColor;
+    f32 speed, life;
+    f32 size, endSize;
+} ParticleEmitter;
+
+// Matches EmitRequest in particles.comp
+typedef struct {
+    ParticleEmitter emitter;
+    u32             first; // Index of its first particle among this update's new ones
+    u32             _pad[3];
+} EmitRequest;
+
+// The indirect draw and dispatch arguments, plus the append counter of the buffer written to
+typedef struct {
+    u32 indexCount, instanceCount, firstIndex, baseVertex, baseInstance;
+    u32 groups[3];
+    u32 appended;
+} ParticleCounters;
+
+// Matches the PARTICLE_* defines in particles.comp
+typedef enum {
+    PARTICLE_SIMULATE,
+    PARTICLE_EMIT,
+    PARTICLE_FINISH,
+    PARTICLE_PASS_COUNT
+} ParticlePass;
+
+struct ParticleShaders {
+    Shader passes[PARTICLE_PASS_COUNT];
+    Shader draw;
+};
+ParticleShaders NewParticleShaders();
+
+typedef struct {
+    u32          buffers[2]; // Particles, swapped every update
+    u32          current;    // Buffer holding the live ones
+    u32          counters;   // ParticleCounters
+    u32          capacity;
+    StreamBuffer emits; // EmitRequests for the next update
+    u32          emitCount, emitTotal;
+    u32          seed;
+    v2           gravity; // World units per second squared
+    f32          drag;    // Fraction of the velocity lost per second
+} ParticleSystem;
+ParticleSystem NewParticleSystem(u32 capacity);
+void           EmitParticles(ParticleSystem *system, ParticleEmitter emitter, u32 count);
+void           UpdateParticles(ParticleSystem *system, f32 dt);
+void           DrawParticles(const ParticleSystem *system);
@@ -0,0 +1,296 @@
+#include "rendergraph.h"
+
+RenderGraph NewRenderGraph() {
+    RenderGraph result = {.dirty = true, .renderScale = 1};
+    glGenVertexArrays(1, &result.vao);
+    return result;
+}
+
+RenderTarget RenderGraphFind(const RenderGraph *graph, cstr name) {
+    for (u32 i = 0; i < graph->targetCount; i++)
+        if (!SDL_strcmp(graph->targets[i].name, name)) return i + 2;
+    return RT_NONE;
+}
+
+RenderTarget RenderGraphTarget(RenderGraph *graph, RenderTargetDesc desc) {
+    if (desc.scale <= 0) desc.scale = 1;
+    if (!desc.format) desc.format = GL_RGBA8;
+    graph->dirty = true;
+
+    RenderTarget found = RenderGraphFind(graph, desc.name);
+    if (found) {
+        graph->targets[found - 2] = desc;
+        return found;
+    }
+
+    if (graph->targetCount == RG_MAX_TARGETS) {
+        LOG_ERROR("Too many render targets");
+        return RT_NONE;
+    }
+    graph->targets[graph->targetCount] = desc;
+    return 2 + graph->targetCount++;
+}
+
+void RenderGraphPass(RenderGraph *graph, RenderPass pass) {
+    graph->dirty = true;
+    for (u32 i = 0; i < graph->passCount; i++) {
+        if (SDL_strcmp(graph->passes[i].name, pass.name)) continue;
+        graph->passes[i] = pass;
+        return;
+    }
+
+    if (graph->passCount == RG_MAX_PASSES) {
+        LOG_ERROR("Too many render passes");
+        return;
+    }
+    graph->passes[graph->passCount++] = pass;
+}
+
+intern void RenderPassRun(const RenderPass *pass) {
+    switch (pass->kind) {
+    case PASS_SCENE: ScenePass(pass); break;
+    case PASS_LIGHTS: LightsPass(pass); break;
+#ifdef DEBUG
+    case PASS_DEBUG: DebugPass(pass); break;
+#endif
+    default: pass->execute(pass); break;
+    }
+}
+
+intern bool RenderPassReads(const RenderPass *pass, RenderTarget target) {
+    for (u32 i = 0; i < RG_MAX_INPUTS && pass->inputs[i]; i++)
+        if (pass->inputs[i] == target) return true;
+    return false;
+}
+
+intern RenderTexture NewRenderTexture(v2i size, u32 format, bool depth) {
+    RenderTexture result = {.size = size, .format = format, .depth = depth};
+
+    glGenTextures(1, &result.tex);
+    glBindTexture(GL_TEXTURE_2D, result.tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, format, size.w, size.h);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &result.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, result.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, result.tex, 0);
+
+    if (depth) {
+        glGenRenderbuffers(1, &result.rbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, result.rbo);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.w, size.h);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                                  result.rbo);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG_ERROR("Render target %dx%d is incomplete", size.w, size.h);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    return result;
+}
+
+intern void FreeRenderTexture(RenderTexture *texture) {
+    glDeleteFramebuffers(1, &texture->fbo);
+    glDeleteTextures(1, &texture->tex);
+    if (texture->rbo) glDeleteRenderbuffers(1, &texture->rbo);
+    *texture = (RenderTexture){0};
+}
+
+// Sorts the passes so every target is written before it's read, keeping declaration order
+// otherwise, then drops the passes that don't lead to the window.
+intern void RenderGraphSort(RenderGraph *graph) {
+    u32  sorted[RG_MAX_PASSES];
+    u32  sortedCount           = 0;
+    bool placed[RG_MAX_PASSES] = {0};
+
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (u32 i = 0; i < graph->passCount; i++) {
+            if (placed[i]) continue;
+
+            bool ready = true;
+            for (u32 j = 0; j < graph->passCount && ready; j++)
+                if (j != i && !placed[j])
+                    ready = !RenderPassReads(&graph->passes[i], graph->passes[j].output);
+            if (!ready) continue;
+
+            placed[i]             = true;
+            sorted[sortedCount++] = i;
+            progress              = true;
+        }
+    }
+    if (sortedCount < graph->passCount) LOG_ERROR("Render graph has a cycle, skipping it");
+
+    bool needed[RG_MAX_TARGETS + 2] = {[RT_WINDOW] = true};
+    bool live[RG_MAX_PASSES]        = {0};
+    for (i32 i = (i32)sortedCount - 1; i >= 0; i--) {
+        const RenderPass *pass = &graph->passes[sorted[i]];
+        if (!needed[pass->output]) continue;
+
+        live[i] = true;
+        for (u32 j = 0; j < RG_MAX_INPUTS && pass->inputs[j]; j++) needed[pass->inputs[j]] = true;
+    }
+
+    graph->orderCount = 0;
+    for (u32 i = 0; i < sortedCount; i++)
+        if (live[i]) graph->order[graph->orderCount++] = sorted[i];
+}
+
+// A pooled texture is reused by the next target that's first used after its last reader
+intern void RenderGraphAllocate(RenderGraph *graph, v2i size) {
+    i32 first[RG_MAX_TARGETS], last[RG_MAX_TARGETS];
+    for (u32 t = 0; t < graph->targetCount; t++) {
+        first[t] = last[t]  = -1;
+        graph->physical[t] = -1;
+    }
+
+    for (u32 i = 0; i < graph->orderCount; i++) {
+        const RenderPass *pass = &graph->passes[graph->order[i]];
+        RenderTarget      used[RG_MAX_INPUTS + 1];
+        u32               usedCount = 0;
+        for (u32 j = 0; j < RG_MAX_INPUTS && pass->inputs[j]; j++)
+            used[usedCount++] = pass->inputs[j];
+        used[usedCount++] = pass->output;
+
+        for (u32 j = 0; j < usedCount; j++) {
+            if (used[j] < 2) continue;
+            u32 t = used[j] - 2;
+            if (first[t] < 0) first[t] = (i32)i;
+            last[t] = (i32)i;
+        }
+    }
+
+    for (u32 p = 0; p < RG_MAX_TARGETS; p++) graph->pool[p].busyUntil = -1;
+
+    // Targets are handed out in order of first use, so a freed texture goes to the next one
+    for (u32 i = 0; i < graph->orderCount; i++) {
+        for (u32 t = 0; t < graph->targetCount; t++) {
+            if (first[t] != (i32)i) continue;
+
+            RenderTargetDesc desc = graph->targets[t];
+            v2i              want = {MAX((i32)(size.w * desc.scale), 1),
+                                     MAX((i32)(size.h * desc.scale), 1)};
+
+            i32 match = -1, empty = -1;
+            for (u32 p = 0; p < RG_MAX_TARGETS; p++) {
+                RenderTexture *texture = &graph->pool[p];
+                if (!texture->fbo) {
+                    if (empty < 0) empty = (i32)p;
+                } else if (texture->busyUntil < first[t] && texture->size.w == want.w &&
+                           texture->size.h == want.h && texture->format == desc.format &&
+                           texture->depth == desc.depth) {
+                    match = (i32)p;
+                    break;
+                }
+            }
+
+            if (match < 0) {
+                if (empty < 0) {
+                    LOG_ERROR("Render target pool is full");
+                    continue;
+                }
+                match              = empty;
+                graph->pool[match] = NewRenderTexture(want, desc.format, desc.depth);
+            }
+
+            graph->pool[match].busyUntil = last[t];
+            graph->physical[t]           = match;
+        }
+    }
+
+    for (u32 p = 0; p < RG_MAX_TARGETS; p++)
+        if (graph->pool[p].fbo && graph->pool[p].busyUntil < 0) FreeRenderTexture(&graph->pool[p]);
+}
+
+intern void RenderGraphCompile(RenderGraph *graph, v2i size) {
+    if (size.w != graph->size.w || size.h != graph->size.h)
+        for (u32 p = 0; p < RG_MAX_TARGETS; p++)
+            if (graph->pool[p].fbo) FreeRenderTexture(&graph->pool[p]);
+
+    RenderGraphSort(graph);
+    RenderGraphAllocate(graph, size);
+    graph->size  = size;
+    graph->dirty = false;
+}
+
+Texture RenderGraphTexture(const RenderGraph *graph, RenderTarget target) {
+    if (target < 2 || target - 2 >= graph->targetCount) return (Texture){0};
+    i32 p = graph->physical[target - 2];
+    if (p < 0) return (Texture){0};
+    return (Texture){.id = graph->pool[p].tex, .nChan = 4, .size = graph->pool[p].size};
+}
+
+// The part of the target's texture that passes draw to
+v2i RenderGraphViewport(const RenderGraph *graph, RenderTarget target) {
+    if (target == RT_WINDOW) return graph->size;
+    Texture texture = RenderGraphTexture(graph, target);
+    if (!texture.id || !graph->targets[target - 2].dynamic) return texture.size;
+
+    return (v2i){MAX((i32)(texture.size.w * graph->renderScale + 0.5f), 1),
+                 MAX((i32)(texture.size.h * graph->renderScale + 0.5f), 1)};
+}
+
+void RenderGraphExecute(RenderGraph *graph) {
+    v2  res  = GetResolution();
+    v2i size = {(i32)res.w, (i32)res.h};
+    if (size.w <= 0 || size.h <= 0) return; // Minimized
+
+    if (graph->dirty || size.w != graph->size.w || size.h != graph->size.h)
+        RenderGraphCompile(graph, size);
+
+    for (u32 i = 0; i < graph->orderCount; i++) {
+        const RenderPass *pass = &graph->passes[graph->order[i]];
+
+        RenderTexture *output = 0;
+        if (pass->output >= 2) {
+            i32 p = graph->physical[pass->output - 2];
+            if (p < 0) continue;
+            output = &graph->pool[p];
+        }
+        v2i viewport = RenderGraphViewport(graph, pass->output);
+        glBindFramebuffer(GL_FRAMEBUFFER, output ? output->fbo : 0);
+        glViewport(0, 0, viewport.w, viewport.h);
+
+        if (pass->clear) {
+            glClearColor(pass->clearColor.r, pass->clearColor.g, pass->clearColor.b,
+                         pass->clearColor.a);
+            glClear(GL_COLOR_BUFFER_BIT | (output && output->depth ? GL_DEPTH_BUFFER_BIT : 0));
+        }
+
+        u32 inputCount = 0;
+        for (; inputCount < RG_MAX_INPUTS && pass->inputs[inputCount]; inputCount++)
+            TextureUse(RenderGraphTexture(graph, pass->inputs[inputCount]), inputCount);
+
+        if (pass->kind != PASS_CUSTOM || pass->execute) {
+            RenderPassRun(pass);
+            FlushBatches();
+        } else {
+            ShaderUse(pass->shader);
+            for (u32 j = 0; j < inputCount; j++) {
+                Texture texture = RenderGraphTexture(graph, pass->inputs[j]);
+                v2i     used    = RenderGraphViewport(graph, pass->inputs[j]);
+                char    name[16];
+
+                SDL_snprintf(name, sizeof(name), "tex%u", j);
+                SetUniform1i(name, (i32)j);
+                SDL_snprintf(name, sizeof(name), "texScale%u", j);
+                SetUniform2f(name, texture.id ? (v2){(f32)used.w / texture.size.w,
+                                                     (f32)used.h / texture.size.h}
+                                              : (v2){1, 1});
+            }
+
+            glBindVertexArray(graph->vao);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            LOG_GL_ERROR("Drawing failed");
+        }
+    }
+
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, size.w, size.h);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "engine.h"
+#include "graphics.h"
+
+// Frames are drawn through a graph of passes over named render targets. Passes run in the
+// order their inputs require, and passes whose output never reaches the window are skipped.
+// Targets are transient: their textures come from a pool, targets whose lifetimes don't
+// overlap share one, and everything is reallocated when the window size changes.
+//
+// Dynamic targets are allocated at their full scale but only drawn into their bottom left
+// renderScale part, so the scale can change every frame without reallocating. Shader passes
+// get texScale0, texScale1... with the part of each input that holds the image.
+//
+// A pass can list RT_WINDOW as an input to run after every other pass writing to the window,
+// for overlays. Nothing is bound for it.
+#define RG_MAX_TARGETS 32
+#define RG_MAX_PASSES 32
+#define RG_MAX_INPUTS 4
+
+typedef u32 RenderTarget;
+#define RT_NONE 0
+#define RT_WINDOW 1 // The default framebuffer
+
+typedef struct {
+    cstr name;
+    f32  scale;   // Of the window size
+    u32  format;  // Sized internal format, GL_RGBA8 when 0
+    bool depth;   // Adds a depth-stencil buffer
+    bool dynamic; // Drawn at the graph's renderScale
+} RenderTargetDesc;
+
+// The graph outlives a hot reload, so the engine's own passes are picked by kind instead of
+// through execute, which would keep calling into the old DLL. Game passes still use execute
+// and have to be added again to pick up reloaded code.
+typedef enum { PASS_CUSTOM, PASS_SCENE, PASS_LIGHTS, PASS_DEBUG } RenderPassKind;
+
+typedef struct RenderPass RenderPass;
+struct RenderPass {
+    cstr           name;
+    RenderPassKind kind;
+    RenderTarget   inputs[RG_MAX_INPUTS]; // Bound to tex0, tex1... up to the first RT_NONE
+    RenderTarget   output;
+    Shader         shader; // Drawn over the whole output, for custom passes without execute
+    void (*execute)(const RenderPass *pass);
+    bool clear;
+    v4   clearColor;
+};
+void ScenePass(const RenderPass *pass);
+void LightsPass(const RenderPass *pass);
+void DebugPass(const RenderPass *pass); // Debug builds only
+
+typedef struct {
+    u32  fbo, tex, rbo;
+    v2i  size;
+    u32  format;
+    bool depth;
+    i32  busyUntil; // Last pass using it, while compiling
+} RenderTexture;
+
+struct RenderGraph {
+    RenderTargetDesc targets[RG_MAX_TARGETS];
+    i32              physical[RG_MAX_TARGETS]; // Index into pool, -1 when unused
+    u32              targetCount;
+    RenderPass       passes[RG_MAX_PASSES];
+    u32              passCount;
+    u32              order[RG_MAX_PASSES]; // Live passes, in execution order
+    u32              orderCount;
+    RenderTexture    pool[RG_MAX_TARGETS];
+    v2i              size;        // Of the window when the pool was built
+    f32              renderScale; // Of dynamic targets, (0, 1]
+    bool             dirty;
+    u32              vao; // Empty, for the fullscreen triangle
+};
+RenderGraph  NewRenderGraph();
+RenderTarget RenderGraphTarget(RenderGraph *graph, RenderTargetDesc desc);
+RenderTarget RenderGraphFind(const RenderGraph *graph, cstr name);
+void         RenderGraphPass(RenderGraph *graph, RenderPass pass); // Replaces same-named ones
+void         RenderGraphExecute(RenderGraph *graph);
+Texture      RenderGraphTexture(const RenderGraph *graph, RenderTarget target);
+v2i          RenderGraphViewport(const RenderGraph *graph, RenderTarget target);
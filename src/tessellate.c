@@ -0,0 +1,313 @@
+#include "tessellate.h"
+
+// Across the line from its left feather edge to its right one
+typedef struct {
+    v2 p[4];
+} LineSection;
+
+typedef struct {
+    f32 half, feather;
+    f32 core, edge; // Distances from the center to the opaque part's edge and to the feather's
+    v4  colors[4];  // Across a section
+    v4  clear;
+} LineBrush;
+
+intern f32 Dot(v2 a, v2 b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+intern f32 Cross(v2 a, v2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+intern v2 LeftNormal(v2 dir) {
+    return (v2){-dir.y, dir.x};
+}
+
+intern void Tri(v2 a, v4 ca, v2 b, v4 cb, v2 c, v4 cc) {
+    PolyPushTriangle((PolyVertex){a, ca}, (PolyVertex){b, cb}, (PolyVertex){c, cc});
+}
+
+// Corners in order around it
+intern void Quad(v2 a, v4 ca, v2 b, v4 cb, v2 c, v4 cc, v2 d, v4 cd) {
+    Tri(a, ca, b, cb, c, cc);
+    Tri(a, ca, c, cc, d, cd);
+}
+
+// Center and size, with margin around the points
+intern Rect PolyBounds(Poly poly, f32 margin) {
+    v2 lo = poly.verts[0], hi = poly.verts[0];
+    for (u32 i = 1; i < poly.count; i++) {
+        lo = (v2){MIN(lo.x, poly.verts[i].x), MIN(lo.y, poly.verts[i].y)};
+        hi = (v2){MAX(hi.x, poly.verts[i].x), MAX(hi.y, poly.verts[i].y)};
+    }
+    return (Rect){(lo.x + hi.x) / 2, (lo.y + hi.y) / 2, hi.x - lo.x + margin * 2,
+                  hi.y - lo.y + margin * 2};
+}
+
+intern bool SamePoint(v2 a, v2 b) {
+    return f32Abs(a.x - b.x) < 1e-6f && f32Abs(a.y - b.y) < 1e-6f;
+}
+
+// The first point after i, up to end, that isn't on top of it. end + 1 when there's none.
+intern u32 NextDistinct(Poly poly, u32 i, u32 end) {
+    u32 next = i + 1;
+    while (next <= end && SamePoint(poly.verts[next], poly.verts[i])) next++;
+    return next;
+}
+
+// The feather is a pixel wide at the current zoom. Lines thinner than that are all feather
+// and only partly cover their pixels, which their alpha accounts for.
+intern LineBrush NewLineBrush(f32 thickness, v4 color) {
+    LineBrush result = {.half = thickness / 2, .feather = 1.0f / CameraScale(Graphics()->cam)};
+    result.core      = MAX(result.half - result.feather / 2, 0);
+    result.edge      = result.half + result.feather / 2;
+
+    if (thickness < result.feather) color.a *= thickness / result.feather;
+    result.clear     = (v4){color.r, color.g, color.b, 0};
+    result.colors[0] = result.clear;
+    result.colors[1] = color;
+    result.colors[2] = color;
+    result.colors[3] = result.clear;
+    return result;
+}
+
+// left is the unit normal scaled by the miter length, if any
+intern LineSection LineSectionAt(v2 p, v2 left, const LineBrush *brush) {
+    return (LineSection){{
+        v2Add(p, v2Scale(left, brush->edge)),
+        v2Add(p, v2Scale(left, brush->core)),
+        v2Sub(p, v2Scale(left, brush->core)),
+        v2Sub(p, v2Scale(left, brush->edge)),
+    }};
+}
+
+intern void LineStrip(LineSection a, LineSection b, const v4 *colorsA, const v4 *colorsB,
+                      const LineBrush *brush) {
+    for (u32 i = 0; i < 3; i++) {
+        if (i == 1 && brush->core <= 0) continue;
+        Quad(a.p[i], colorsA[i], a.p[i + 1], colorsA[i + 1], b.p[i + 1], colorsB[i + 1], b.p[i],
+             colorsB[i]);
+    }
+}
+
+// A fan around p, starting in direction from and turning by sweep radians
+intern void LineWedge(v2 p, f32 from, f32 sweep, u32 steps, const LineBrush *brush) {
+    v4 color = brush->colors[1];
+    v2 dir   = {cosf(from), sinf(from)};
+    for (u32 i = 1; i <= steps; i++) {
+        f32 angle = from + sweep * i / steps;
+        v2  next  = {cosf(angle), sinf(angle)};
+        v2  core0 = v2Add(p, v2Scale(dir, brush->core));
+        v2  core1 = v2Add(p, v2Scale(next, brush->core));
+        v2  edge0 = v2Add(p, v2Scale(dir, brush->edge));
+        v2  edge1 = v2Add(p, v2Scale(next, brush->edge));
+
+        if (brush->core > 0) Tri(p, color, core0, color, core1, color);
+        Quad(core0, color, edge0, brush->clear, edge1, brush->clear, core1, color);
+        dir = next;
+    }
+}
+
+intern u32 RoundSteps(f32 sweep) {
+    return MAX((u32)ceilf(f32Abs(sweep) / TESS_ROUND_STEP), 1u);
+}
+
+// Sections at the end of the segment coming into p along d0 and at the start of the one
+// leaving it along d1. Miters share one section. Otherwise the inside of the turn still does,
+// and the gap left on the outside is filled with a bevel or an arc.
+intern void LineJoint(v2 p, v2 d0, v2 d1, LineJoin join, const LineBrush *brush,
+                      LineSection *in, LineSection *out) {
+    v2  n0    = LeftNormal(d0);
+    v2  n1    = LeftNormal(d1);
+    v2  miter = v2Add(n0, n1);
+    f32 len   = Length(miter);
+    f32 scale = len > 1e-4f ? 2.0f / len : TESS_MITER_LIMIT; // 1 / cos(half the turn)
+    v2  inner = len > 1e-4f ? v2Scale(miter, MIN(scale, TESS_MITER_LIMIT) / len) : (v2){0};
+    f32 turn  = Cross(d0, d1);
+
+    bool straight = f32Abs(turn) < 1e-6f && Dot(d0, d1) > 0;
+    if (straight || (join == JOIN_MITER && scale <= TESS_MITER_LIMIT)) {
+        *in = *out = LineSectionAt(p, inner, brush);
+        return;
+    }
+
+    f32 sweep = atan2f(Cross(n0, n1), Dot(n0, n1));
+    u32 steps = join == JOIN_ROUND ? RoundSteps(sweep) : 1;
+    if (turn > 0) {
+        // Turning left, so the outside is on the right
+        LineSection inside = LineSectionAt(p, inner, brush);
+        *in                = LineSectionAt(p, n0, brush);
+        *out               = LineSectionAt(p, n1, brush);
+        in->p[0] = out->p[0] = inside.p[0];
+        in->p[1] = out->p[1] = inside.p[1];
+        LineWedge(p, Angle(v2Scale(n0, -1)), sweep, steps, brush);
+    } else {
+        LineSection inside = LineSectionAt(p, inner, brush);
+        *in                = LineSectionAt(p, n0, brush);
+        *out               = LineSectionAt(p, n1, brush);
+        in->p[2] = out->p[2] = inside.p[2];
+        in->p[3] = out->p[3] = inside.p[3];
+        LineWedge(p, Angle(n0), sweep, steps, brush);
+    }
+}
+
+// The section where the line starts or ends at p, going along dir, with its cap past it.
+// Butt and square ends fade out over the feather like the sides do.
+intern LineSection LineEnd(v2 p, v2 dir, bool end, LineCap cap, const LineBrush *brush) {
+    v2 outward = end ? dir : v2Scale(dir, -1);
+    v2 left    = LeftNormal(dir);
+
+    if (cap == CAP_ROUND) {
+        // Half a turn from the left side to the right one, through outward
+        LineWedge(p, Angle(left), end ? -PI : PI, RoundSteps(PI), brush);
+        return LineSectionAt(p, left, brush);
+    }
+
+    f32 extend = cap == CAP_SQUARE ? brush->half : 0;
+    v2  at     = v2Add(p, v2Scale(outward, extend - brush->feather / 2));
+    v2  fade   = v2Scale(outward, brush->feather);
+
+    LineSection section = LineSectionAt(at, left, brush);
+    LineSection faded   = section;
+    for (u32 i = 0; i < 4; i++) faded.p[i] = v2Add(faded.p[i], fade);
+
+    v4 clear[4] = {brush->clear, brush->clear, brush->clear, brush->clear};
+    LineStrip(section, faded, brush->colors, clear, brush);
+    return section;
+}
+
+void DrawPolyline(Poly poly, LineStyle style, v4 color) {
+    if (poly.count < 2 || style.thickness <= 0) return;
+
+    LineBrush brush = NewLineBrush(style.thickness, color);
+    f32       reach = brush.edge * (style.join == JOIN_MITER ? TESS_MITER_LIMIT : 1);
+    if (Culled(PolyBounds(poly, reach), 0)) return;
+
+    // A closing point on top of the first one is implied
+    u32 end = poly.count - 1;
+    if (style.closed)
+        while (end > 0 && SamePoint(poly.verts[end], poly.verts[0])) end--;
+
+    v2 *p    = poly.verts;
+    u32 next = NextDistinct(poly, 0, end);
+    if (next > end) return;
+    v2 dir = Direction(p[0], p[next]);
+
+    LineSection prevOut, closeIn, in, out;
+    if (style.closed)
+        LineJoint(p[0], Direction(p[end], p[0]), dir, style.join, &brush, &closeIn, &prevOut);
+    else
+        prevOut = LineEnd(p[0], dir, false, style.cap, &brush);
+
+    while (true) {
+        u32 at = next;
+        next   = NextDistinct(poly, at, end);
+
+        if (next > end) {
+            if (style.closed) {
+                LineJoint(p[at], dir, Direction(p[at], p[0]), style.join, &brush, &in, &out);
+                LineStrip(prevOut, in, brush.colors, brush.colors, &brush);
+                LineStrip(out, closeIn, brush.colors, brush.colors, &brush);
+            } else {
+                in = LineEnd(p[at], dir, true, style.cap, &brush);
+                LineStrip(prevOut, in, brush.colors, brush.colors, &brush);
+            }
+            break;
+        }
+
+        v2 nextDir = Direction(p[at], p[next]);
+        LineJoint(p[at], dir, nextDir, style.join, &brush, &in, &out);
+        LineStrip(prevOut, in, brush.colors, brush.colors, &brush);
+        prevOut = out;
+        dir     = nextDir;
+    }
+}
+
+// Convex at b, going around in orient's direction, with no other vertex left inside
+intern bool IsEar(Poly poly, const u16 *ring, u32 count, u32 at, f32 orient) {
+    u32 ia = ring[(at + count - 1) % count], ib = ring[at], ic = ring[(at + 1) % count];
+    v2  a  = poly.verts[ia], b = poly.verts[ib], c = poly.verts[ic];
+    if (CrossV2(a, b, c) * orient <= 0) return false;
+
+    for (u32 i = 0; i < count; i++) {
+        u32 k = ring[i];
+        if (k == ia || k == ib || k == ic) continue;
+
+        v2 p = poly.verts[k];
+        if (CrossV2(a, b, p) * orient >= 0 && CrossV2(b, c, p) * orient >= 0 &&
+            CrossV2(c, a, p) * orient >= 0)
+            return false;
+    }
+    return true;
+}
+
+// Outward offset of vertex i, as a miter of its two edges' normals
+intern v2 PolyOutward(Poly poly, u32 count, u32 i, f32 orient) {
+    v2 prev = poly.verts[(i + count - 1) % count];
+    v2 at   = poly.verts[i];
+    v2 next = poly.verts[(i + 1) % count];
+    v2 n0   = v2Scale(LeftNormal(Direction(prev, at)), -orient);
+    v2 n1   = v2Scale(LeftNormal(Direction(at, next)), -orient);
+
+    v2  miter = v2Add(n0, n1);
+    f32 len   = Length(miter);
+    if (len < 1e-4f) return n0;
+    return v2Scale(miter, MIN(2.0f / len, TESS_MITER_LIMIT) / len);
+}
+
+void DrawPolygon(Poly poly, v4 color) {
+    u32 count = poly.count;
+    if (count > 1 && SamePoint(poly.verts[count - 1], poly.verts[0])) count--;
+    if (count < 3) return;
+    if (count > TESS_MAX_POLY_POINTS) {
+        LOG_WARNING("Polygon has %u points, can't fill more than %u", count,
+                    TESS_MAX_POLY_POINTS);
+        return;
+    }
+
+    f32 feather = 1.0f / CameraScale(Graphics()->cam);
+    if (Culled(PolyBounds(poly, feather * TESS_MITER_LIMIT), 0)) return;
+
+    // Twice the signed area, whose sign gives the winding
+    f32 area = 0;
+    for (u32 i = 0; i < count; i++) area += Cross(poly.verts[i], poly.verts[(i + 1) % count]);
+    if (area == 0) return;
+    f32 orient = area > 0 ? 1.0f : -1.0f;
+
+    // Clip ears until a triangle is left. Going around once without finding one means the
+    // polygon intersects itself, and what's left of it is dropped.
+    u16 ring[TESS_MAX_POLY_POINTS];
+    for (u32 i = 0; i < count; i++) ring[i] = (u16)i;
+
+    u32 left = count, at = 0, misses = 0;
+    while (left > 3 && misses < left) {
+        if (!IsEar(poly, ring, left, at, orient)) {
+            at = (at + 1) % left;
+            misses++;
+            continue;
+        }
+
+        u32 a = ring[(at + left - 1) % left], b = ring[at], c = ring[(at + 1) % left];
+        Tri(poly.verts[a], color, poly.verts[b], color, poly.verts[c], color);
+        SDL_memmove(&ring[at], &ring[at + 1], (left - at - 1) * sizeof(ring[0]));
+        left--;
+        if (at == left) at = 0;
+        misses = 0;
+    }
+    if (left == 3)
+        Tri(poly.verts[ring[0]], color, poly.verts[ring[1]], color, poly.verts[ring[2]], color);
+
+    // The edges fade out over a pixel outside the polygon
+    v4 clear = {color.r, color.g, color.b, 0};
+    v2 first = v2Scale(PolyOutward(poly, count, 0, orient), feather);
+    v2 out0  = first;
+    for (u32 i = 0; i < count; i++) {
+        u32 j    = (i + 1) % count;
+        v2  out1 = j ? v2Scale(PolyOutward(poly, count, j, orient), feather) : first;
+        v2  a    = poly.verts[i];
+        v2  b    = poly.verts[j];
+        Quad(a, color, b, color, v2Add(b, out1), clear, v2Add(a, out0), clear);
+        out0 = out1;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "engine.h"
+#include "graphics.h"
+
+// Lines and polygons are turned into triangles on the CPU and pushed to the poly batch. Edges
+// get a one pixel feather, a strip fading to transparent, so they're antialiased without MSAA.
+// Thick lines are split into that strip on each side and an opaque core, and sub-pixel lines
+// are all feather, with their alpha scaled by how much of the pixel they cover.
+#define TESS_MITER_LIMIT 4.0f      // Of the half thickness, longer miters are beveled
+#define TESS_ROUND_STEP (PI / 8)   // Largest angle covered by one triangle of a round join
+#define TESS_MAX_POLY_POINTS 1024  // For filled polygons
+
+typedef enum { JOIN_MITER, JOIN_BEVEL, JOIN_ROUND } LineJoin;
+typedef enum { CAP_BUTT, CAP_SQUARE, CAP_ROUND } LineCap;
+
+typedef struct {
+    f32      thickness; // In world units
+    LineJoin join;
+    LineCap  cap;
+    bool     closed; // Joins the last point back to the first, without caps
+} LineStyle;
+void DrawPolyline(Poly poly, LineStyle style, v4 color);
+
+// Simple polygons in either winding, triangulated by ear clipping
+void DrawPolygon(Poly poly, v4 color);
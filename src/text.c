@@ -0,0 +1,270 @@
+#include "text.h"
+#include "pack.h"
+
+intern Glyph FontBakeGlyph(TTF_Font *ttf, u32 ch) {
+    Glyph result = {0};
+    if (!TTF_GetGlyphMetrics(ttf, ch, 0, 0, 0, 0, &result.advance)) return result;
+
+    SDL_Surface *rendered = TTF_RenderGlyph_Blended(ttf, ch, (SDL_Color){255, 255, 255, 255});
+    if (!rendered) return result; // Whitespace has nothing to render
+
+    SDL_Surface *rgba = SDL_ConvertSurface(rendered, SDL_PIXELFORMAT_ABGR8888);
+    SDL_DestroySurface(rendered);
+    SDL_CHECK(rgba, "Failed to convert glyph surface");
+    if (!rgba) return result;
+
+    result.sprite  = AtlasAddPixels(Graphics()->atlas, rgba->pixels, (v2i){rgba->w, rgba->h});
+    result.size    = (v2i){rgba->w, rgba->h};
+    result.visible = result.sprite.id != 0;
+    SDL_DestroySurface(rgba);
+
+    return result;
+}
+
+intern Font *FindFont(cstr path, f32 size, bool sdf) {
+    GraphicsCtx *ctx = Graphics();
+    for (u32 i = 0; i < ctx->fontCount; i++) {
+        Font *font = &ctx->fonts[i];
+        bool  same = font->size == size && (font->sdf.id != 0) == sdf;
+        if (same && SDL_strcmp(font->path, path) == 0) return font;
+    }
+    return 0;
+}
+
+intern bool FontRejected(cstr path) {
+    if (SDL_strlen(path) >= FONT_PATH_MAX) {
+        LOG_ERROR("Font path %s is too long", path);
+        return true;
+    }
+    if (Graphics()->fontCount < MAX_FONTS) return false;
+    LOG_ERROR("Too many fonts loaded, can't load %s", path);
+    return true;
+}
+
+Font *GetFont(cstr path, f32 size) {
+    Font *result = FindFont(path, size, false);
+    if (result || FontRejected(path)) return result;
+
+    TTF_Font *ttf = TTF_OpenFontIO(LoadAssetIO(path), true, size);
+    SDL_CHECK(ttf, "Failed to open font");
+    if (!ttf) return 0;
+
+    result             = &Graphics()->fonts[Graphics()->fontCount++];
+    result->ttf        = ttf;
+    result->size       = size;
+    result->lineHeight = TTF_GetFontLineSkip(ttf);
+    SDL_strlcpy(result->path, path, FONT_PATH_MAX);
+    for (u32 i = 0; i < FONT_GLYPH_COUNT; i++)
+        result->glyphs[i] = FontBakeGlyph(ttf, FONT_FIRST_GLYPH + i);
+
+    return result;
+}
+
+intern Texture SdfNewPage(v2i size, const u8 *pixels) {
+    Texture result = {.size = size, .nChan = 1};
+
+    glGenTextures(1, &result.id);
+    glBindTexture(GL_TEXTURE_2D, result.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, size.w, size.h, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    LOG_GL_ERROR("Couldn't upload distance field page");
+
+    return result;
+}
+
+// Packed caches were checked against their font by the packer
+intern bool SdfLoadCache(Font *font, cstr cachePath, cstr fontPath) {
+    if (!PackFind(Pack(), cachePath)) {
+        SDL_PathInfo fontInfo, cacheInfo;
+        if (!SDL_GetPathInfo(cachePath, &cacheInfo) || !SDL_GetPathInfo(fontPath, &fontInfo))
+            return false;
+        if (cacheInfo.modify_time < fontInfo.modify_time) return false;
+    }
+
+    string                cache  = LoadAsset(cachePath);
+    const SdfCacheHeader *header = (const SdfCacheHeader *)cache.data;
+    if (!cache.data || cache.len < sizeof(SdfCacheHeader) || header->magic != SDF_CACHE_MAGIC ||
+        header->version != SDF_CACHE_VERSION ||
+        cache.len != sizeof(SdfCacheHeader) + (u64)header->pageSize.w * header->pageSize.h) {
+        FreeAsset(cache);
+        return false;
+    }
+
+    font->size       = header->size;
+    font->lineHeight = header->lineHeight;
+    font->sdf        = SdfNewPage(header->pageSize, (const u8 *)(header + 1));
+    SDL_memcpy(font->glyphs, header->glyphs, sizeof(font->glyphs));
+
+    FreeAsset(cache);
+    return true;
+}
+
+// Rasterizes every glyph as a distance field (FreeType's SDF renderer, through SDL_ttf) and
+// packs them into a single-channel page, which is also written to disk for the next run
+intern bool SdfGenerate(Font *font, cstr cachePath, cstr fontPath) {
+    TTF_Font *ttf = TTF_OpenFontIO(LoadAssetIO(fontPath), true, SDF_BASE_SIZE);
+    SDL_CHECK(ttf, "Failed to open font");
+    if (!ttf) return false;
+    SDL_CHECK(TTF_SetFontSDF(ttf, true), "Failed to enable distance field rendering");
+
+    v2i             pageSize = {SDF_PAGE_SIZE, SDF_PAGE_SIZE};
+    u64             len      = sizeof(SdfCacheHeader) + (u64)pageSize.w * pageSize.h;
+    u8             *data     = SDL_calloc(1, len);
+    SdfCacheHeader *header   = (SdfCacheHeader *)data;
+    u8             *pixels   = data + sizeof(SdfCacheHeader);
+    Skyline         packer   = NewSkyline(pageSize);
+
+    *header = (SdfCacheHeader){
+        .magic      = SDF_CACHE_MAGIC,
+        .version    = SDF_CACHE_VERSION,
+        .size       = SDF_BASE_SIZE,
+        .lineHeight = TTF_GetFontLineSkip(ttf),
+        .pageSize   = pageSize,
+    };
+
+    for (u32 i = 0; i < FONT_GLYPH_COUNT; i++) {
+        Glyph *glyph = &header->glyphs[i];
+        u32    ch    = FONT_FIRST_GLYPH + i;
+        if (!TTF_GetGlyphMetrics(ttf, ch, 0, 0, 0, 0, &glyph->advance)) continue;
+
+        SDL_Surface *rendered = TTF_RenderGlyph_Blended(ttf, ch, (SDL_Color){255, 255, 255, 255});
+        if (!rendered) continue;
+        SDL_Surface *rgba = SDL_ConvertSurface(rendered, SDL_PIXELFORMAT_ABGR8888);
+        SDL_DestroySurface(rendered);
+        if (!rgba) continue;
+
+        v2i pos = {0};
+        if (SkylinePack(&packer, (v2i){rgba->w + 1, rgba->h + 1}, &pos)) {
+            for (i32 y = 0; y < rgba->h; y++) {
+                u8 *src = (u8 *)rgba->pixels + y * rgba->pitch;
+                u8 *dst = pixels + (pos.y + y) * pageSize.w + pos.x;
+                for (i32 x = 0; x < rgba->w; x++) dst[x] = src[x * 4 + 3];
+            }
+
+            glyph->size    = (v2i){rgba->w, rgba->h};
+            glyph->uv      = (Rect){(f32)pos.x / pageSize.w, (f32)pos.y / pageSize.h,
+                                    (f32)rgba->w / pageSize.w, (f32)rgba->h / pageSize.h};
+            glyph->visible = true;
+        } else {
+            LOG_WARNING("Glyph %c doesn't fit in the distance field page", ch);
+        }
+        SDL_DestroySurface(rgba);
+    }
+    TTF_CloseFont(ttf);
+
+    font->size       = header->size;
+    font->lineHeight = header->lineHeight;
+    font->sdf        = SdfNewPage(pageSize, pixels);
+    SDL_memcpy(font->glyphs, header->glyphs, sizeof(font->glyphs));
+
+    // A packed font means a release build, which leaves data/ alone
+    if (PackFind(Pack(), fontPath))
+        LOG_WARNING("%s isn't in the pack, repack after running a debug build", cachePath);
+    else if (!SDL_SaveFile(cachePath, data, len))
+        LOG_WARNING("Couldn't write distance field cache %s: %s", cachePath, SDL_GetError());
+
+    SDL_free(data);
+    return true;
+}
+
+Font *GetSdfFont(cstr path) {
+    Font *result = FindFont(path, SDF_BASE_SIZE, true);
+    if (result || FontRejected(path)) return result;
+
+    char cachePath[512];
+    SDL_snprintf(cachePath, sizeof(cachePath), "%s.sdf", path);
+
+    result       = &Graphics()->fonts[Graphics()->fontCount];
+    *result      = (Font){0};
+    SDL_strlcpy(result->path, path, FONT_PATH_MAX);
+    bool success = SdfLoadCache(result, cachePath, path) || SdfGenerate(result, cachePath, path);
+    if (!success) return 0;
+
+    Graphics()->fontCount++;
+    return result;
+}
+
+intern const Glyph *FontGlyph(const Font *font, char ch) {
+    u32 i = (u8)ch - FONT_FIRST_GLYPH;
+    return &font->glyphs[i < FONT_GLYPH_COUNT ? i : '?' - FONT_FIRST_GLYPH];
+}
+
+intern i32 WordWidth(const Font *font, cstr word) {
+    i32 result = 0;
+    for (; *word && *word != ' ' && *word != '\n'; word++)
+        result += FontGlyph(font, *word)->advance;
+    return result;
+}
+
+// Walks the text applying word wrap; when draw is false it only measures
+intern v2 LayoutText(const Font *font, cstr text, v2 pos, f32 scale, v4 color, f32 wrapWidth,
+                     bool draw) {
+    v2  pen    = {0, 0};
+    f32 widest = 0;
+    f32 line   = font->lineHeight * scale;
+
+    for (cstr c = text; *c; c++) {
+        bool wordStart = c == text || c[-1] == ' ';
+        if (*c == '\n' || (wrapWidth > 0 && wordStart && pen.x > 0 &&
+                           pen.x + WordWidth(font, c) * scale > wrapWidth)) {
+            widest = fmaxf(widest, pen.x);
+            pen    = (v2){0, pen.y + line};
+            if (*c == '\n') continue;
+        }
+
+        const Glyph *glyph = FontGlyph(font, *c);
+        if (draw && glyph->visible) {
+            Rect dst = {pos.x + pen.x, pos.y + pen.y, glyph->size.w * scale,
+                        glyph->size.h * scale};
+            if (font->sdf.id)
+                BatchPushShader(SHADER_Text, font->sdf.id, dst, glyph->uv, color, 0);
+            else
+                DrawSpriteEx(glyph->sprite, dst, 0, color);
+        }
+        pen.x += glyph->advance * scale;
+    }
+
+    return (v2){fmaxf(widest, pen.x), pen.y + line};
+}
+
+v2 MeasureText(const Font *font, cstr text, f32 wrapWidth) {
+    if (!font) return (v2){0};
+    return LayoutText(font, text, (v2){0}, 1, COLOR_NULL, wrapWidth, false);
+}
+
+void DrawTextEx(const Font *font, cstr text, v2 pos, v4 color, f32 wrapWidth) {
+    if (!font) return;
+    LayoutText(font, text, pos, 1, color, wrapWidth, true);
+}
+
+void DrawTextScaled(const Font *font, cstr text, v2 pos, f32 size, v4 color, f32 wrapWidth) {
+    if (!font) return;
+    LayoutText(font, text, pos, size / font->size, color, wrapWidth, true);
+}
+
+void DrawTextf(const Font *font, v2 pos, v4 color, cstr fmt, ...) {
+    char    buf[TEXT_FORMAT_MAX];
+    va_list args;
+    va_start(args, fmt);
+    SDL_vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    DrawTextEx(font, buf, pos, color, 0);
+}
+
+Text NewText(cstr text, cstr fontPath, f32 size, i32 wrapChars) {
+    return (Text){
+        .text = text,
+        .font = GetFont(fontPath, size),
+        .wrap = wrapChars * size,
+    };
+}
+
+void DrawText(Text text, v2 pos) {
+    DrawTextEx(text.font, text.text, pos, WHITE, text.wrap);
+}
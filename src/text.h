@@ -0,0 +1,57 @@
+#pragma once
+
+#include "atlas.h"
+#include "engine.h"
+#include "graphics.h"
+
+// Printable ASCII, rasterized into the runtime atlas once when the font is loaded
+#define FONT_FIRST_GLYPH 32
+#define FONT_GLYPH_COUNT 95
+#define MAX_FONTS 16
+#define FONT_PATH_MAX 128
+#define TEXT_FORMAT_MAX 256
+
+// Distance field fonts are generated once at this size and scaled freely afterwards
+#define SDF_BASE_SIZE 48
+#define SDF_PAGE_SIZE 1024
+#define SDF_CACHE_MAGIC 0x46445348 // "HSDF"
+#define SDF_CACHE_VERSION 1
+
+typedef struct {
+    Sprite sprite; // Bitmap fonts, in the runtime atlas
+    Rect   uv;     // Distance field fonts, in the font's own page
+    v2i    size;
+    i32    advance;
+    bool   visible;
+} Glyph;
+
+typedef struct Font {
+    TTF_Font *ttf;
+    char      path[FONT_PATH_MAX]; // Copied, callers can pass temporary buffers
+    f32       size;
+    i32       lineHeight;
+    Texture   sdf;
+    Glyph     glyphs[FONT_GLYPH_COUNT];
+} Font;
+Font *GetFont(cstr path, f32 size);
+Font *GetSdfFont(cstr path);
+v2    MeasureText(const Font *font, cstr text, f32 wrapWidth);
+void  DrawTextEx(const Font *font, cstr text, v2 pos, v4 color, f32 wrapWidth);
+void  DrawTextScaled(const Font *font, cstr text, v2 pos, f32 size, v4 color, f32 wrapWidth);
+void  DrawTextf(const Font *font, v2 pos, v4 color, cstr fmt, ...);
+
+typedef struct {
+    u32   magic, version;
+    f32   size;
+    i32   lineHeight;
+    v2i   pageSize;
+    Glyph glyphs[FONT_GLYPH_COUNT];
+} SdfCacheHeader;
+
+typedef struct {
+    cstr  text;
+    Font *font;
+    f32   wrap;
+} Text;
+Text NewText(cstr text, cstr fontPath, f32 size, i32 wrapChars);
+void DrawText(Text text, v2 pos);
@@ -0,0 +1,211 @@
+#include "tilemap.h"
+
+Tileset NewTileset(cstr path, v2i tileSize) {
+    Tileset result = (Tileset){
+        .tex       = NewTexture(path),
+        .uv        = (Rect){0, 0, 1, 1},
+        .tileSize  = tileSize,
+        .atlasSize = (v2i){result.tex.size.w / tileSize.w, result.tex.size.h / tileSize.h}};
+
+    return result;
+}
+
+Tileset NewTilesetFromAtlas(cstr path, v2i tileSize) {
+    Sprite       sprite = NewSprite(path);
+    AtlasSprite *s      = AtlasGet(Graphics()->atlas, sprite);
+
+    return (Tileset){
+        .tex       = Graphics()->atlas->pages[s->page],
+        .uv        = s->uv,
+        .tileSize  = tileSize,
+        .atlasSize = (v2i){s->size.w / tileSize.w, s->size.h / tileSize.h},
+    };
+}
+
+Tilemap NewTilemap(u32 *data, v2i size) {
+    return NewTilemapLayers(data, size, 1);
+}
+
+Tilemap NewTilemapLayers(u32 *data, v2i size, u32 layers) {
+    if (layers > MAX_TILE_LAYERS) {
+        LOG_WARNING("Tilemaps support up to %d layers, got %u", MAX_TILE_LAYERS, layers);
+        layers = MAX_TILE_LAYERS;
+    }
+
+    Tilemap result = {
+        .data       = data,
+        .size       = size,
+        .layers     = layers,
+        .chunkCount = {(size.w + CHUNK_SIZE - 1) / CHUNK_SIZE,
+                       (size.h + CHUNK_SIZE - 1) / CHUNK_SIZE},
+    };
+    result.chunks = SDL_calloc(result.chunkCount.w * result.chunkCount.h, sizeof(TileChunk));
+
+    return result;
+}
+
+u32 TilemapAddAnim(Tilemap *map, const u32 *frames, u32 count, f32 secondsPerFrame) {
+    if (map->animCount == MAX_TILE_ANIMS || map->animFrameCount + count > MAX_TILE_ANIM_FRAMES) {
+        LOG_ERROR("Tilemap animation table is full");
+        return TILE_EMPTY;
+    }
+
+    SDL_memcpy(&map->animFrames[map->animFrameCount], frames, count * sizeof(u32));
+    map->anims[map->animCount] = (TileAnim){
+        .first      = map->animFrameCount,
+        .count      = count,
+        .msPerFrame = (u32)MAX(secondsPerFrame * 1000.0f, 1.0f),
+    };
+    map->animFrameCount += count;
+
+    return TILE_ANIMATED | map->animCount++;
+}
+
+intern bool TilemapContains(const Tilemap *map, u32 layer, v2i tile) {
+    return layer < map->layers && tile.x >= 0 && tile.y >= 0 && tile.x < map->size.w &&
+           tile.y < map->size.h;
+}
+
+// Tiles outside the map read as empty
+u32 TilemapGet(const Tilemap *map, u32 layer, v2i tile) {
+    if (!TilemapContains(map, layer, tile)) return TILE_EMPTY;
+    return map->data[(layer * map->size.h + tile.y) * map->size.w + tile.x];
+}
+
+void TilemapSet(Tilemap *map, u32 layer, v2i tile, u32 value) {
+    if (!TilemapContains(map, layer, tile)) {
+        LOG_ERROR("Tile %d,%d on layer %u is outside the %dx%dx%u map", tile.x, tile.y, layer,
+                  map->size.w, map->size.h, map->layers);
+        return;
+    }
+    if (value != TILE_EMPTY && (value & TILE_ANIMATED) &&
+        (value & ~TILE_ANIMATED) >= map->animCount) {
+        LOG_ERROR("Tile animation %u doesn't exist", value & ~TILE_ANIMATED);
+        return;
+    }
+
+    map->data[(layer * map->size.h + tile.y) * map->size.w + tile.x] = value;
+    TilemapMarkDirty(map, tile, tile);
+}
+
+void TilemapMarkDirty(Tilemap *map, v2i min, v2i max) {
+    min = (v2i){MAX(min.x, 0), MAX(min.y, 0)};
+    max = (v2i){MIN(max.x, map->size.w - 1), MIN(max.y, map->size.h - 1)};
+
+    for (i32 cy = min.y / CHUNK_SIZE; cy <= max.y / CHUNK_SIZE; cy++) {
+        for (i32 cx = min.x / CHUNK_SIZE; cx <= max.x / CHUNK_SIZE; cx++) {
+            TileChunk *chunk = &map->chunks[cy * map->chunkCount.w + cx];
+            if (!chunk->tex) continue; // Gets its full upload when first drawn
+
+            v2i chunkMin = {MAX(min.x, cx * CHUNK_SIZE), MAX(min.y, cy * CHUNK_SIZE)};
+            v2i chunkMax = {MIN(max.x, cx * CHUNK_SIZE + CHUNK_SIZE - 1),
+                            MIN(max.y, cy * CHUNK_SIZE + CHUNK_SIZE - 1)};
+            if (!chunk->dirty) {
+                chunk->dirtyMin = chunkMin;
+                chunk->dirtyMax = chunkMax;
+                chunk->dirty    = true;
+            } else {
+                chunk->dirtyMin = (v2i){MIN(chunk->dirtyMin.x, chunkMin.x),
+                                        MIN(chunk->dirtyMin.y, chunkMin.y)};
+                chunk->dirtyMax = (v2i){MAX(chunk->dirtyMax.x, chunkMax.x),
+                                        MAX(chunk->dirtyMax.y, chunkMax.y)};
+            }
+        }
+    }
+}
+
+intern void TilemapUpload(const Tilemap *map, u32 tex, v2i chunkPos, v2i min, v2i max) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, map->size.w);
+    for (u32 layer = 0; layer < map->layers; layer++) {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, min.x - chunkPos.x, min.y - chunkPos.y, layer,
+                        max.x - min.x + 1, max.y - min.y + 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                        &map->data[(layer * map->size.h + min.y) * map->size.w + min.x]);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    LOG_GL_ERROR("Couldn't upload tilemap chunk");
+}
+
+intern void TilemapChunkUpdate(Tilemap *map, v2i chunkCoord) {
+    TileChunk *chunk    = &map->chunks[chunkCoord.y * map->chunkCount.w + chunkCoord.x];
+    v2i        chunkPos = {chunkCoord.x * CHUNK_SIZE, chunkCoord.y * CHUNK_SIZE};
+
+    if (!chunk->tex) {
+        glGenTextures(1, &chunk->tex);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, chunk->tex);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R32UI, CHUNK_SIZE, CHUNK_SIZE, map->layers);
+
+        chunk->dirty    = true;
+        chunk->dirtyMin = chunkPos;
+        chunk->dirtyMax = (v2i){MIN(chunkPos.x + CHUNK_SIZE, map->size.w) - 1,
+                                MIN(chunkPos.y + CHUNK_SIZE, map->size.h) - 1};
+    }
+
+    if (!chunk->dirty) return;
+    TilemapUpload(map, chunk->tex, chunkPos, chunk->dirtyMin, chunk->dirtyMax);
+    chunk->dirty = false;
+}
+
+void TilemapUpdate(Tilemap *map) {
+    for (i32 cy = 0; cy < map->chunkCount.h; cy++) {
+        for (i32 cx = 0; cx < map->chunkCount.w; cx++) {
+            TileChunk *chunk = &map->chunks[cy * map->chunkCount.w + cx];
+            if (chunk->tex && chunk->dirty) TilemapChunkUpdate(map, (v2i){cx, cy});
+        }
+    }
+}
+
+void TilemapDraw(Tilemap *map, Tileset set, v2 pos) {
+    FlushBatches();
+
+    v2   tileSize  = {(f32)set.tileSize.w, (f32)set.tileSize.h};
+    v2   chunkSize = v2Scale(tileSize, CHUNK_SIZE);
+    Rect view      = CameraViewRect(Graphics()->cam);
+
+    // Only the chunks overlapping the view are touched at all
+    i32 x0 = MAX((i32)floorf((view.x - pos.x) / chunkSize.w), 0);
+    i32 y0 = MAX((i32)floorf((view.y - pos.y) / chunkSize.h), 0);
+    i32 x1 = MIN((i32)floorf((view.x + view.w - pos.x) / chunkSize.w), map->chunkCount.w - 1);
+    i32 y1 = MIN((i32)floorf((view.y + view.h - pos.y) / chunkSize.h), map->chunkCount.h - 1);
+    if (x0 > x1 || y0 > y1) return;
+
+    ShaderUse(Graphics()->builtinShaders[SHADER_Tiles]);
+    TextureUse(set.tex, 0);
+    SetUniform1i("tileAtlas", 0);
+    SetUniform1i("tilemap", 1);
+    SetUniform2i("atlasSize", set.atlasSize);
+    SetUniform4f("atlasRect", (v4){set.uv.x, set.uv.y, set.uv.w, set.uv.h});
+    SetUniform1f("rotation", 0);
+    SetUniform4f("color", COLOR_NULL);
+    SetUniform1i("layerCount", map->layers);
+    SetUniform4uiv("anims", (u32 *)map->anims, map->animCount);
+    SetUniform1uiv("animFrames", map->animFrames, map->animFrameCount);
+
+    glBindVertexArray(Graphics()->builtinVAOs[VAO_SQUARE].id);
+    LOG_GL_ERROR("VAO binding failed");
+    for (i32 cy = y0; cy <= y1; cy++) {
+        for (i32 cx = x0; cx <= x1; cx++) {
+            TilemapChunkUpdate(map, (v2i){cx, cy});
+
+            v2i tiles = {MIN(CHUNK_SIZE, map->size.w - cx * CHUNK_SIZE),
+                         MIN(CHUNK_SIZE, map->size.h - cy * CHUNK_SIZE)};
+            v2  size  = {tiles.w * tileSize.w, tiles.h * tileSize.h};
+            v2  start = {pos.x + cx * chunkSize.w, pos.y + cy * chunkSize.h};
+
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, map->chunks[cy * map->chunkCount.w + cx].tex);
+            SetUniform2f("pos", v2Add(start, v2Scale(size, 0.5f)));
+            SetUniform2f("size", size);
+            SetUniform2i("chunkTiles", tiles);
+
+            DrawElement();
+            LOG_GL_ERROR("Drawing failed");
+        }
+    }
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "atlas.h"
+#include "engine.h"
+#include "graphics.h"
+
+typedef struct {
+    Texture tex;
+    Rect    uv; // Region of tex holding the tiles
+    v2i     tileSize;
+    v2i     atlasSize;
+} Tileset;
+Tileset NewTileset(cstr path, v2i tileSize);
+Tileset NewTilesetFromAtlas(cstr path, v2i tileSize);
+
+// Maps are split in CHUNK_SIZE x CHUNK_SIZE chunks, each with its own index texture that is
+// created the first time the chunk is on screen. Edits only re-upload the dirty rect of the
+// chunks they touch. Every layer of a chunk lives in the same array texture and they're all
+// composited in one draw.
+#define CHUNK_SIZE 64
+#define MAX_TILE_LAYERS 4
+
+// Animated tiles are TILE_ANIMATED | index into the map's animation table, and get resolved
+// to a frame by tiles.frag from the time uniform
+#define TILE_EMPTY 0xFFFFFFFF
+#define TILE_ANIMATED 0x80000000
+#define MAX_TILE_ANIMS 64
+#define MAX_TILE_ANIM_FRAMES 256
+
+typedef struct {
+    u32 first, count, msPerFrame, _pad;
+} TileAnim;
+
+typedef struct {
+    u32  tex;
+    v2i  dirtyMin, dirtyMax; // Inclusive, in map tiles
+    bool dirty;
+} TileChunk;
+
+typedef struct {
+    u32       *data; // Layers one after the other, each size.w * size.h
+    v2i        size;
+    u32        layers;
+    v2i        chunkCount;
+    TileChunk *chunks;
+
+    TileAnim anims[MAX_TILE_ANIMS];
+    u32      animFrames[MAX_TILE_ANIM_FRAMES];
+    u32      animCount, animFrameCount;
+} Tilemap;
+Tilemap NewTilemap(u32 *data, v2i size);
+Tilemap NewTilemapLayers(u32 *data, v2i size, u32 layers);
+u32     TilemapAddAnim(Tilemap *map, const u32 *frames, u32 count, f32 secondsPerFrame);
+u32     TilemapGet(const Tilemap *map, u32 layer, v2i tile);
+void    TilemapSet(Tilemap *map, u32 layer, v2i tile, u32 value);
+void    TilemapMarkDirty(Tilemap *map, v2i min, v2i max);
+void    TilemapUpdate(Tilemap *map);
+void    TilemapDraw(Tilemap *map, Tileset set, v2 pos);
@@ -0,0 +1,102 @@
+// Headless audio harness. Runs the engine without a window and renders BENCH_SECONDS of 64,
+// then 256, then 1024 looping voices through the offline mixer, logging the mixing cost of
+// each. Everything is synthetic and stepped at a fixed rate, so audiobench.wav comes out
+// identical on every run and can be diffed against a golden copy after mixer changes.
+#include "../engine.c"
+
+#define BENCH_SECONDS 4
+#define BENCH_UPDATES (BENCH_SECONDS * OFFLINE_UPDATE_RATE)
+#define BENCH_TONE_FRAMES 4800
+#define BENCH_WAV "audiobench.wav"
+
+global const u32 BenchVoices[] = {64, 256, 1024};
+
+struct GameState {
+    f32 *tone;
+    u32  phase;
+};
+_Static_assert(sizeof(GameState) <= GAME_STATE_SIZE, "GameState is too big");
+
+// A 100 Hz saw wave, built without libm so the render is the same everywhere
+intern f32 *BenchTone() {
+    f32 *tone = SDL_malloc(BENCH_TONE_FRAMES * MIX_FRAME_SIZE);
+    for (u32 i = 0; i < BENCH_TONE_FRAMES; i++) {
+        f32 saw                    = (f32)(i % 480) / 240.0f - 1.0f;
+        tone[i * MIX_CHANNELS + 0] = saw;
+        tone[i * MIX_CHANNELS + 1] = -saw;
+    }
+    return tone;
+}
+
+intern void BenchPhase(u32 phase) {
+    AudioCtx *audio    = Audio();
+    u32       voices   = BenchVoices[phase];
+    audio->soundsCount = voices + 1; // After the silent voice 0
+    audio->mixTicks    = 0;
+    audio->mixFrames   = 0;
+
+    for (u32 i = 0; i < voices; i++) {
+        SoundBuffer voice = {
+            .data    = (u8 *)S->tone,
+            .len     = BENCH_TONE_FRAMES * MIX_FRAME_SIZE,
+            .played  = (i * 37 % BENCH_TONE_FRAMES) * MIX_FRAME_SIZE,
+            .vol     = 1.0f / voices,
+            .pan     = (f32)(i % 17) / 8.0f - 1.0f,
+            .type    = LOOPING,
+            .playing = true,
+        };
+        SoundUpdateGains(&voice, voice.vol, voice.pan);
+        audio->sounds[i + 1] = voice;
+    }
+}
+
+intern void BenchReport(u32 phase) {
+    AudioCtx *audio    = Audio();
+    f64       ns       = (f64)audio->mixTicks * 1e9 / (f64)SDL_GetPerformanceFrequency();
+    f64       perFrame = audio->mixFrames ? ns / (f64)audio->mixFrames : 0;
+
+    // Realtime budget is one frame every 1/MIX_FREQ seconds
+    LOG_INFO("%4u voices: %.1f ns per mixed frame, %.2f%% of realtime", BenchVoices[phase],
+             perFrame, perFrame * MIX_FREQ / 1e7);
+}
+
+export void Setup() {
+    *Settings() = (GameSettings){
+        .name            = "Audio benchmark",
+        .version         = "0.1",
+        .headless        = true,
+        .headlessUpdates = BENCH_UPDATES * SDL_arraysize(BenchVoices),
+        .audioVoices     = BenchVoices[SDL_arraysize(BenchVoices) - 1],
+    };
+}
+
+export void Init() {
+    S->tone = BenchTone();
+    AudioSinkOpenWav(&Audio()->sink, BENCH_WAV);
+    BenchPhase(0);
+}
+
+// Runs before each update's audio is rendered, so a phase covers exactly BENCH_UPDATES of them
+export void Update() {
+    u32 phase = (u32)((Timing()->updates - 1) / BENCH_UPDATES);
+    if (phase == S->phase) return;
+
+    BenchReport(S->phase);
+    S->phase = phase;
+    BenchPhase(phase);
+}
+
+export void Draw() {}
+
+i32 main() {
+    E = (EngineCtx *)malloc(ENGINE_MEMORY_SIZE);
+
+    EngineLoadGame(Setup, Init, Update, Draw);
+    EngineInit();
+    while (EngineIsRunning()) EngineUpdate();
+    BenchReport(S->phase);
+    EngineShutdown();
+
+    LOG_INFO("Wrote " BENCH_WAV);
+    free(E);
+}
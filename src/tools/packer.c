@@ -0,0 +1,221 @@
+// Offline asset packer. Walks data/ and shaders/, decodes images to ABGR8888 and sounds to the
+// mixing format, and writes everything into one pack (see pack.h) that release builds map at
+// startup. Run from the repo root: packer [out], out defaults to data.pack.
+#include "../audio.h"
+#include "../pack.h"
+
+typedef struct {
+    PackEntry entry;
+    void     *data;
+} PackItem;
+
+typedef struct {
+    PackItem *items;
+    u32       count, max;
+    bool      failed;
+} Packer;
+
+intern cstr PackerExtension(cstr path) {
+    cstr dot = SDL_strrchr(path, '.');
+    return dot ? dot : "";
+}
+
+intern bool PackerIsImage(cstr ext) {
+    return !SDL_strcasecmp(ext, ".png") || !SDL_strcasecmp(ext, ".ico") ||
+           !SDL_strcasecmp(ext, ".bmp") || !SDL_strcasecmp(ext, ".jpg") ||
+           !SDL_strcasecmp(ext, ".tga");
+}
+
+intern bool PackerLoadImage(PackItem *item, cstr path) {
+    SDL_Surface *img = IMG_Load(path);
+    if (!img) {
+        LOG_ERROR("Couldn't load %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    SDL_Surface *rgba = SDL_ConvertSurface(img, SDL_PIXELFORMAT_ABGR8888);
+    SDL_DestroySurface(img);
+    if (!rgba) {
+        LOG_ERROR("Couldn't convert %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    // Rows are stored tightly packed, whatever pitch SDL picked
+    item->entry.type = PACK_IMAGE;
+    item->entry.w    = rgba->w;
+    item->entry.h    = rgba->h;
+    item->entry.len  = (u64)rgba->w * rgba->h * 4;
+    item->data       = SDL_malloc(item->entry.len);
+    for (i32 y = 0; y < rgba->h; y++)
+        SDL_memcpy((u8 *)item->data + y * rgba->w * 4, (u8 *)rgba->pixels + y * rgba->pitch,
+                   rgba->w * 4);
+    SDL_DestroySurface(rgba);
+
+    return true;
+}
+
+intern bool PackerLoadSound(PackItem *item, cstr path) {
+    SDL_AudioSpec spec   = {0};
+    u8           *wav    = 0;
+    u32           wavLen = 0;
+    if (!SDL_LoadWAV(path, &spec, &wav, &wavLen)) {
+        LOG_ERROR("Loading file %s failed: %s", path, SDL_GetError());
+        return false;
+    }
+
+    SDL_AudioSpec mixSpec = {.channels = MIX_CHANNELS, .format = SDL_AUDIO_F32, .freq = MIX_FREQ};
+    u8           *mix     = 0;
+    i32           mixLen  = 0;
+    bool ok = SDL_ConvertAudioSamples(&spec, wav, (i32)wavLen, &mixSpec, &mix, &mixLen);
+    SDL_free(wav);
+    if (!ok) {
+        LOG_ERROR("Couldn't convert %s to the mixing format: %s", path, SDL_GetError());
+        return false;
+    }
+
+    item->entry.type = PACK_SOUND;
+    item->entry.len  = (u64)mixLen;
+    item->data       = mix;
+
+    return true;
+}
+
+intern bool PackerLoadRaw(PackItem *item, cstr path) {
+    size_t len = 0;
+    item->data = SDL_LoadFile(path, &len);
+    if (!item->data) {
+        LOG_ERROR("Couldn't read %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    item->entry.type = PACK_RAW;
+    item->entry.len  = len;
+
+    return true;
+}
+
+intern SDL_EnumerationResult PackerAddDir(void *userdata, cstr dirname, cstr fname) {
+    Packer *packer = userdata;
+
+    char path[PACK_PATH_MAX];
+    if (SDL_snprintf(path, sizeof(path), "%s%s", dirname, fname) >= PACK_PATH_MAX) {
+        LOG_ERROR("Path %s%s is too long to pack", dirname, fname);
+        packer->failed = true;
+        return SDL_ENUM_CONTINUE;
+    }
+    for (char *c = path; *c; c++)
+        if (*c == '\\') *c = '/';
+
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(path, &info)) return SDL_ENUM_CONTINUE;
+    if (info.type == SDL_PATHTYPE_DIRECTORY) {
+        SDL_EnumerateDirectory(path, PackerAddDir, packer);
+        return SDL_ENUM_CONTINUE;
+    }
+
+    // Distance field caches are packed so release builds never bake them, as long as they're
+    // newer than their font. The game writes them next to the font in debug runs.
+    cstr ext = PackerExtension(path);
+    if (!SDL_strcasecmp(ext, ".sdf")) {
+        char fontPath[PACK_PATH_MAX];
+        SDL_strlcpy(fontPath, path, ext - path + 1);
+
+        SDL_PathInfo fontInfo;
+        if (SDL_GetPathInfo(fontPath, &fontInfo) && fontInfo.modify_time > info.modify_time) {
+            LOG_WARNING("%s is older than %s, run the game to regenerate it", path, fontPath);
+            return SDL_ENUM_CONTINUE;
+        }
+    }
+
+    if (packer->count == packer->max) {
+        packer->max   = packer->max ? packer->max * 2 : 64;
+        packer->items = SDL_realloc(packer->items, packer->max * sizeof(PackItem));
+    }
+
+    PackItem item = {0};
+    SDL_strlcpy(item.entry.path, path, PACK_PATH_MAX);
+    item.entry.hash = PackHash(path);
+
+    bool ok = PackerIsImage(ext)               ? PackerLoadImage(&item, path)
+              : !SDL_strcasecmp(ext, ".wav") ? PackerLoadSound(&item, path)
+                                             : PackerLoadRaw(&item, path);
+    if (!ok) {
+        packer->failed = true;
+        return SDL_ENUM_CONTINUE;
+    }
+
+    packer->items[packer->count++] = item;
+    return SDL_ENUM_CONTINUE;
+}
+
+intern i32 PackerCompare(const void *a, const void *b) {
+    u64 ha = ((const PackItem *)a)->entry.hash, hb = ((const PackItem *)b)->entry.hash;
+    return ha < hb ? -1 : ha > hb;
+}
+
+intern u64 PackerAlign(u64 offset) {
+    return (offset + PACK_ALIGN - 1) & ~(u64)(PACK_ALIGN - 1);
+}
+
+intern bool PackerWrite(Packer *packer, cstr outPath) {
+    SDL_qsort(packer->items, packer->count, sizeof(PackItem), PackerCompare);
+    for (u32 i = 1; i < packer->count; i++) {
+        if (packer->items[i].entry.hash != packer->items[i - 1].entry.hash) continue;
+        LOG_ERROR("%s and %s hash to the same value", packer->items[i].entry.path,
+                  packer->items[i - 1].entry.path);
+        return false;
+    }
+
+    u64 offset = PackerAlign(sizeof(PackHeader) + (u64)packer->count * sizeof(PackEntry));
+    for (u32 i = 0; i < packer->count; i++) {
+        packer->items[i].entry.offset = offset;
+        offset = PackerAlign(offset + packer->items[i].entry.len + 1);
+    }
+
+    SDL_IOStream *out = SDL_IOFromFile(outPath, "wb");
+    if (!out) {
+        LOG_ERROR("Couldn't open %s: %s", outPath, SDL_GetError());
+        return false;
+    }
+
+    PackHeader header = {.magic = PACK_MAGIC, .version = PACK_VERSION, .entryCount = packer->count};
+    bool       ok     = SDL_WriteIO(out, &header, sizeof(header)) == sizeof(header);
+    for (u32 i = 0; i < packer->count; i++)
+        ok &= SDL_WriteIO(out, &packer->items[i].entry, sizeof(PackEntry)) == sizeof(PackEntry);
+
+    persist u8 zeros[PACK_ALIGN];
+    for (u32 i = 0; i < packer->count && ok; i++) {
+        PackEntry *entry = &packer->items[i].entry;
+        u64        pos   = (u64)SDL_TellIO(out);
+        ok &= SDL_WriteIO(out, zeros, entry->offset - pos) == entry->offset - pos;
+        ok &= SDL_WriteIO(out, packer->items[i].data, entry->len) == entry->len;
+        ok &= SDL_WriteIO(out, zeros, 1) == 1;
+    }
+
+    u64 pos = (u64)SDL_TellIO(out);
+    ok &= SDL_WriteIO(out, zeros, offset - pos) == offset - pos;
+    ok &= SDL_CloseIO(out);
+    if (!ok) LOG_ERROR("Couldn't write %s: %s", outPath, SDL_GetError());
+
+    return ok;
+}
+
+i32 main(i32 argc, char **argv) {
+    cstr   outPath = argc > 1 ? argv[1] : PACK_DEFAULT_PATH;
+    Packer packer  = {0};
+
+    SDL_EnumerateDirectory("data", PackerAddDir, &packer);
+    SDL_EnumerateDirectory("shaders", PackerAddDir, &packer);
+    if (packer.failed || !PackerWrite(&packer, outPath)) return 1;
+
+    u64 total = 0;
+    for (u32 i = 0; i < packer.count; i++) {
+        total += packer.items[i].entry.len;
+        SDL_free(packer.items[i].data);
+    }
+    SDL_free(packer.items);
+
+    LOG_INFO("Packed %u assets, %llu bytes into %s", packer.count, (unsigned long long)total,
+             outPath);
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include "watcher.h"
+#include "assets.h"
+#include "debugdraw.h"
+#include "graphics.h"
+#include "lights.h"
+#include "particles.h"
+#include "rendergraph.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOUSER
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Called from the watcher thread. Repeated events for a file just push its deadline back.
+intern void WatcherPush(WatcherCtx *watcher, cstr dir, cstr name) {
+    char path[WATCH_PATH_MAX];
+    if (SDL_snprintf(path, sizeof(path), "%s/%s", dir, name) >= WATCH_PATH_MAX) return;
+
+    SDL_LockMutex(watcher->lock);
+    u32 i = 0;
+    while (i < watcher->pendingCount && SDL_strcmp(watcher->pending[i].path, path)) i++;
+    if (i < WATCH_MAX_PENDING) {
+        if (i == watcher->pendingCount) {
+            SDL_strlcpy(watcher->pending[i].path, path, WATCH_PATH_MAX);
+            watcher->pendingCount++;
+        }
+        watcher->pending[i].lastEvent = SDL_GetTicks();
+    }
+    SDL_UnlockMutex(watcher->lock);
+}
+
+#ifdef _WIN32
+intern i32 WatcherThread(void *data) {
+    WatcherCtx *watcher = data;
+    OVERLAPPED  overlapped[WATCH_MAX_DIRS] = {0};
+    HANDLE      events[WATCH_MAX_DIRS];
+    u64         buffers[WATCH_MAX_DIRS][512]; // DWORD aligned, as the API requires
+    DWORD       filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+
+    for (u32 i = 0; i < watcher->dirCount; i++) {
+        events[i] = overlapped[i].hEvent = CreateEventA(0, FALSE, FALSE, 0);
+        ReadDirectoryChangesW(watcher->handles[i], buffers[i], sizeof(buffers[i]), TRUE, filter,
+                              0, &overlapped[i], 0);
+    }
+
+    while (!SDL_GetAtomicInt(&watcher->quit)) {
+        DWORD wait = WaitForMultipleObjects(watcher->dirCount, events, FALSE, 100);
+        if (wait == WAIT_TIMEOUT) continue;
+        u32 dir = wait - WAIT_OBJECT_0;
+        if (dir >= watcher->dirCount) break;
+
+        DWORD bytes = 0;
+        if (GetOverlappedResult(watcher->handles[dir], &overlapped[dir], &bytes, FALSE) && bytes) {
+            FILE_NOTIFY_INFORMATION *info = (FILE_NOTIFY_INFORMATION *)buffers[dir];
+            while (true) {
+                if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED ||
+                    info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+                    char name[WATCH_PATH_MAX];
+                    i32  len = WideCharToMultiByte(CP_UTF8, 0, info->FileName,
+                                                   info->FileNameLength / sizeof(WCHAR), name,
+                                                   sizeof(name) - 1, 0, 0);
+                    name[len] = 0;
+                    WatcherPush(watcher, watcher->dirs[dir], name);
+                }
+                if (!info->NextEntryOffset) break;
+                info = (FILE_NOTIFY_INFORMATION *)((u8 *)info + info->NextEntryOffset);
+            }
+        }
+
+        ReadDirectoryChangesW(watcher->handles[dir], buffers[dir], sizeof(buffers[dir]), TRUE,
+                              filter, 0, &overlapped[dir], 0);
+    }
+
+    for (u32 i = 0; i < watcher->dirCount; i++) {
+        CancelIo(watcher->handles[i]);
+        CloseHandle(events[i]);
+    }
+    return 0;
+}
+#else
+intern i32 WatcherThread(void *data) {
+    WatcherCtx   *watcher = data;
+    u64           buffer[512]; // Aligned for inotify_event
+    struct pollfd fd = {.fd = watcher->fd, .events = POLLIN};
+
+    while (!SDL_GetAtomicInt(&watcher->quit)) {
+        if (poll(&fd, 1, 100) <= 0) continue;
+
+        ssize_t len = read(watcher->fd, buffer, sizeof(buffer));
+        for (u8 *at = (u8 *)buffer; len > 0 && at < (u8 *)buffer + len;) {
+            struct inotify_event *event = (struct inotify_event *)at;
+            at += sizeof(struct inotify_event) + event->len;
+            if (!event->len) continue;
+
+            for (u32 i = 0; i < watcher->dirCount; i++)
+                if (watcher->wds[i] == event->wd)
+                    WatcherPush(watcher, watcher->dirs[i], event->name);
+        }
+    }
+    return 0;
+}
+#endif
+
+WatcherCtx InitWatcher() {
+    WatcherCtx result = {
+        .lock     = SDL_CreateMutex(),
+        .pending  = SDL_calloc(WATCH_MAX_PENDING, sizeof(WatchEvent)),
+        .dirs     = {"data", "shaders"},
+        .dirCount = 2,
+    };
+
+#ifdef _WIN32
+    for (u32 i = 0; i < result.dirCount; i++) {
+        result.handles[i] = CreateFileA(result.dirs[i], FILE_LIST_DIRECTORY,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0,
+                                        OPEN_EXISTING,
+                                        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, 0);
+        if (result.handles[i] == INVALID_HANDLE_VALUE) {
+            LOG_ERROR("Couldn't watch %s: %lu", result.dirs[i], GetLastError());
+            for (u32 j = 0; j < i; j++) CloseHandle(result.handles[j]);
+            result.dirCount = 0;
+        }
+    }
+#else
+    result.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (result.fd < 0) {
+        LOG_ERROR("Couldn't start inotify");
+        result.dirCount = 0;
+    }
+    for (u32 i = 0; i < result.dirCount; i++) {
+        result.wds[i] = inotify_add_watch(result.fd, result.dirs[i],
+                                          IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE);
+        if (result.wds[i] < 0) LOG_ERROR("Couldn't watch %s", result.dirs[i]);
+    }
+#endif
+
+    return result;
+}
+
+void StartWatcher(WatcherCtx *watcher) {
+    if (!watcher->dirCount) return;
+    watcher->thread = SDL_CreateThread(WatcherThread, "watcher", watcher);
+    SDL_CHECK(watcher->thread, "Couldn't start file watcher");
+}
+
+intern void WatcherReload(cstr path) {
+    LOG_INFO("Reloading %s", path);
+
+    // Passes can share a program, like the bloom levels do, so it's reloaded at its first pass
+    // and the new one handed to the others
+    GraphicsCtx *graphics = Graphics();
+    RenderPass  *passes   = graphics->graph->passes;
+    for (u32 i = 0; i < graphics->graph->passCount; i++) {
+        if (!ShaderUsesFile(&passes[i].shader, path)) continue;
+
+        u32  old    = passes[i].shader.id;
+        bool shared = false;
+        for (u32 j = 0; j < i && !shared; j++) shared = passes[j].shader.id == old;
+        if (shared) continue;
+
+        ShaderReload(&passes[i].shader);
+        for (u32 j = i + 1; j < graphics->graph->passCount; j++)
+            if (passes[j].shader.id == old) passes[j].shader = passes[i].shader;
+    }
+    for (i32 i = 0; i < SHADER_COUNT; i++)
+        if (ShaderUsesFile(&graphics->builtinShaders[i], path))
+            ShaderReload(&graphics->builtinShaders[i]);
+    for (i32 i = 0; i < SHADER_MAX_VARIANTS; i++)
+        if (ShaderUsesFile(&graphics->shapes.variants[i], path))
+            ShaderReload(&graphics->shapes.variants[i]);
+    for (i32 i = 0; i < PARTICLE_PASS_COUNT; i++)
+        if (ShaderUsesFile(&graphics->particles->passes[i], path))
+            ShaderReload(&graphics->particles->passes[i]);
+    if (ShaderUsesFile(&graphics->particles->draw, path)) ShaderReload(&graphics->particles->draw);
+#ifdef DEBUG
+    if (ShaderUsesFile(&graphics->debug->shader, path)) ShaderReload(&graphics->debug->shader);
+#endif
+    if (graphics->lighting) {
+        if (ShaderUsesFile(&graphics->lighting->shadowShader, path))
+            ShaderReload(&graphics->lighting->shadowShader);
+        if (ShaderUsesFile(&graphics->lighting->lightShader, path))
+            ShaderReload(&graphics->lighting->lightShader);
+    }
+
+    AssetsReloadFile(Assets(), path);
+}
+
+// Runs on the main thread, since reloading touches GL and the audio voices
+void UpdateWatcher(WatcherCtx *watcher) {
+    if (!watcher->thread) return;
+
+    WatchEvent ready[WATCH_MAX_PENDING];
+    u32        readyCount = 0;
+    u64        now        = SDL_GetTicks();
+
+    SDL_LockMutex(watcher->lock);
+    for (u32 i = 0; i < watcher->pendingCount;) {
+        if (now - watcher->pending[i].lastEvent < WATCH_DEBOUNCE_MS) {
+            i++;
+            continue;
+        }
+        ready[readyCount++] = watcher->pending[i];
+        watcher->pending[i] = watcher->pending[--watcher->pendingCount];
+    }
+    SDL_UnlockMutex(watcher->lock);
+
+    for (u32 i = 0; i < readyCount; i++) WatcherReload(ready[i].path);
+}
+
+void ShutdownWatcher(WatcherCtx *watcher) {
+    SDL_SetAtomicInt(&watcher->quit, 1);
+    if (watcher->thread) SDL_WaitThread(watcher->thread, 0);
+
+#ifdef _WIN32
+    for (u32 i = 0; i < watcher->dirCount; i++) CloseHandle(watcher->handles[i]);
+#else
+    if (watcher->fd > 0) close(watcher->fd);
+#endif
+    if (watcher->lock) SDL_DestroyMutex(watcher->lock);
+    SDL_free(watcher->pending);
+    *watcher = (WatcherCtx){0};
+}
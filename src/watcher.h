@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common.h"
+
+// Debug builds watch data/ and shaders/ from a background thread and reload whatever changed
+// on the main thread. A file is only reloaded once it has gone WATCH_DEBOUNCE_MS without new
+// events, so editors that save in several writes (or through a temp file) only trigger one
+// reload, after the file is complete.
+#define WATCH_MAX_DIRS 2
+#define WATCH_MAX_PENDING 64
+#define WATCH_PATH_MAX 128
+#define WATCH_DEBOUNCE_MS 100
+
+typedef struct {
+    char path[WATCH_PATH_MAX];
+    u64  lastEvent;
+} WatchEvent;
+
+typedef struct {
+    SDL_Thread   *thread;
+    SDL_Mutex    *lock;
+    SDL_AtomicInt quit;
+    WatchEvent   *pending; // WATCH_MAX_PENDING, kept out of EngineCtx
+    u32           pendingCount;
+    cstr          dirs[WATCH_MAX_DIRS];
+    u32           dirCount;
+#ifdef _WIN32
+    void *handles[WATCH_MAX_DIRS];
+#else
+    i32 fd, wds[WATCH_MAX_DIRS];
+#endif
+} WatcherCtx;
+WatcherCtx InitWatcher();
+void       StartWatcher(WatcherCtx *watcher);
+void       UpdateWatcher(WatcherCtx *watcher);
+void       ShutdownWatcher(WatcherCtx *watcher);